@@ -0,0 +1,73 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include <cstdio>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "mem/MemEd.hpp"
+
+using namespace std;
+
+const int BATCH_LIST_CHUNK = 4096; // Rows read in one batch when listing
+
+enum class BatchFormat {
+  JsonLines,
+  Csv
+};
+
+/**
+ * Non-interactive med-cli. One command per line, "#" starts a comment:
+ *   scan <type> <expression>    any scan type, the expression is same as the UI, e.g. "> 10", "<> 1 5", "?"
+ *   filter <type> <expression>
+ *   snapshot                    same as scanning "?"
+ *   scope [<start> <end>]       without the addresses, the scope is cleared
+ *   region <preset> [options]   see RegionPolicy::parse()
+ *   named [<name>]              creates if not exists and activates it, Default without the name
+ *   fast on|off
+ *   count
+ *   list [limit]                streams the results of the active scan
+ *
+ * Every command writes one "command" record with the result count and the elapsed time,
+ * "list" writes a "result" record per row before that. Output is streamed, the results
+ * are read in chunks, so the memory does not grow with the number of the results.
+ */
+class BatchRunner {
+public:
+  BatchRunner(MemEd* memed, FILE* output, BatchFormat format);
+
+  /**
+   * Stops at the first failed command, which is reported as an "error" record.
+   * @return 0 if all the commands succeed, 1 otherwise
+   */
+  int run(istream& script);
+
+  /**
+   * @throw MedException if the command fails or is unknown
+   * @return number of the results of the command
+   */
+  size_t runCommand(const string& command, const string& args);
+
+  static BatchFormat stringToFormat(const string& format); // "jsonl" or "csv"
+
+private:
+  size_t scan(const string& args, bool isFilter);
+  size_t list(const string& args);
+  string checkScanType(const string& scanType);
+
+  void writeHeader();
+  void writeCommand(const string& command, const string& args, size_t count, double ms);
+  void writeResult(const string& address, const string& value, const string& scanType);
+  void writeError(const string& command, const string& args, const string& message);
+  string quote(const string& str);
+
+  MemEd* memed;
+  FILE* output;
+  BatchFormat format;
+  size_t lineNumber;
+  string lastScanType;
+  bool fastScan;
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "med/MedTypes.hpp"
 #include "med/Process.hpp"
 #include "mem/Maps.hpp"
+#include "mem/RegionPolicy.hpp"
 
 using namespace std;
 
@@ -28,7 +29,7 @@ int hexStrToInt(const string& str);
 /**
  * @brief Convert hexadecimal string to integer value
  */
-long hexToInt(string str);
+long hexToInt(const string& str);
 
 /**
  * @brief Convert long integer to hex string
@@ -41,10 +42,40 @@ string intToHex(long int);
 void printHex(FILE* file, void* addr, int size);
 
 /**
+ * Readable and writable regions, for scanning.
  * @param pid is pid_t, which is actually integer.
+ * @throw MedException if the maps cannot be read
  */
 Maps getMaps(pid_t pid);
 
+/**
+ * Readable and writable regions, which are accepted by the policy.
+ * @throw MedException if the maps cannot be read
+ */
+Maps getMaps(pid_t pid, const RegionPolicy& policy);
+
+/**
+ * Same as above, from the maps which are already read.
+ */
+Maps selectMaps(Maps& all, const RegionPolicy& policy);
+
+/**
+ * All the regions, with the permissions and pathname.
+ */
+Maps getAllMaps(pid_t pid);
+
+/**
+ * Raw content of /proc/[pid]/maps, pid 0 is the own process.
+ * @throw MedException if the maps cannot be read
+ */
+string getMapsContent(pid_t pid);
+
+/**
+ * Pointer size of the target, from the ELF class of /proc/[pid]/exe, pid 0 is the own process.
+ * @return 4 for a 32-bit executable, otherwise sizeof(Address), also if it cannot be read
+ */
+int getPointerSize(pid_t pid);
+
 /**
  * Convert the size to padded word size.
  */
@@ -3,21 +3,29 @@
 
 #include "med/MedTypes.hpp"
 
+// Values up to INLINE_SIZE bytes are kept inline, only the longer strings
+// and the custom patterns are allocated.
+// Copying an inline value copies the bytes, so the copies are independent.
+// Only a value on a buffer, i.e. a longer one or one made from a BytePtr,
+// is shared by its copies.
 class SizedBytes {
 public:
+  static const size_t INLINE_SIZE = 16;
+
   SizedBytes();
-  SizedBytes(Byte* bytes, int length);
-  SizedBytes(BytePtr data, int length);
+  SizedBytes(const Byte* bytes, int length); // Copies the bytes
+  SizedBytes(BytePtr data, int length); // Shares the buffer, also with every copy
 
   static SizedBytes create(int length);
 
   size_t getSize();
-  BytePtr getBytePtr();
-  Byte* getBytes();
+  Byte* getBytes(); // NULL if empty
 
   bool isEmpty();
 
 private:
-  pair<BytePtr, size_t> data;
+  BytePtr data; // Only for the values longer than INLINE_SIZE
+  size_t size;
+  Byte inlineBytes[INLINE_SIZE] = {};
 };
 #endif
@@ -20,16 +20,24 @@ public:
 
   void setMaxThreads(int num);
 
+  // Of the last start(), each worker is one of the "maxThreads" slots
+  const std::vector<double>& getBusyMs();
+  double getElapsedMs();
+
 private:
   std::vector<TMTask*> container;
   int maxThreads;
   int numOfRunningThreads;
   int currThreadIndex;
 
+  std::vector<int> freeSlots;
+  std::vector<double> busyMs;
+  double elapsedMs;
+
   std::condition_variable cv;
   std::mutex mut;
 
-  std::future<void> startTask(int index);
+  std::future<void> startTask(int index, int slot);
 };
 
 #endif
@@ -0,0 +1,82 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+using namespace std;
+
+const size_t TRACE_MAX_EVENTS = 4 * 1024 * 1024; // Later events are dropped
+
+struct TraceEvent {
+  const char* name;
+  const char* category;
+  int64_t start; // Nanoseconds since the tracer was created
+  int64_t duration;
+  const char* argName; // Optional
+  uint64_t arg;
+};
+
+// Timeline of the scan workers and the background loops, in Chrome trace event JSON,
+// for chrome://tracing or Perfetto. Started by the MED_TRACE=<file> environment
+// variable, which is written at exit, or by start() and save().
+// Each thread records into its own buffer, so the workers do not contend.
+class Tracer {
+public:
+  static Tracer& get();
+
+  void start(); // Discards the previous events
+  void stop();
+  bool isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  // The names must be string literals, they are kept as pointers
+  void record(const char* name, const char* category, int64_t start, int64_t end,
+              const char* argName = NULL, uint64_t arg = 0);
+  void nameThread(const char* name); // Shown in the viewer instead of the thread id
+
+  size_t size();
+  void save(const string& filename); // @throw MedException if it cannot be written
+
+  int64_t now();
+
+private:
+  struct ThreadEvents {
+    pid_t tid;
+    const char* name;
+    std::mutex mutex; // Only contended by start() and save()
+    vector<TraceEvent> events;
+  };
+
+  Tracer();
+  ~Tracer();
+  ThreadEvents* getThreadEvents();
+
+  std::atomic<bool> enabled;
+  std::atomic<size_t> count;
+  int64_t epoch;
+  string autoSaveFile;
+  vector<shared_ptr<ThreadEvents>> threads; // Kept until exit, a thread may still hold its own
+  std::mutex threadsMutex;
+};
+
+// Records the time from the construction to the destruction, if the tracer is enabled
+class TraceSpan {
+public:
+  TraceSpan(const char* name, const char* category, const char* argName = NULL, uint64_t arg = 0);
+  ~TraceSpan();
+
+private:
+  const char* name;
+  const char* category;
+  const char* argName;
+  uint64_t arg;
+  int64_t start; // -1 if not tracing
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef ADDRESS_RESOLVER_HPP
+#define ADDRESS_RESOLVER_HPP
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/MapsTracker.hpp"
+#include "mem/MemIO.hpp"
+
+using namespace std;
+
+/**
+ * Address which survives the restart of the target, same format as PointerPath::toString().
+ * "0x1234" is absolute, "libtest.so+0x10" is relative to the first mapping of the module,
+ * "[[libtest.so+0x10]+0x8]+0x4" follows the pointers, each bracket is one dereference.
+ */
+struct AddressExpression {
+  string module; // Empty if the base is absolute
+  Address base; // Absolute address, or offset in the module
+  vector<Address> offsets; // Added after each dereference, from the innermost bracket
+
+  bool isAbsolute() const;
+  string toString() const;
+
+  /**
+   * @throw MedException if it is not a valid expression
+   */
+  static AddressExpression parse(const string& str);
+};
+
+// Resolves the expressions of many entries together.
+// The module bases are cached until /proc/[pid]/maps changes. The pointers are
+// read on every resolve, one batched read per level of the deepest chain.
+// Each pointer is read with the pointer size of the target and zero-extended.
+class AddressResolver {
+public:
+  explicit AddressResolver(MemIO* memio);
+
+  /**
+   * @return addresses in the same order, 0 for those cannot be resolved,
+   * i.e. unknown module, unreadable or null pointer
+   */
+  vector<Address> resolve(const vector<AddressExpression>& expressions);
+  Address resolve(const AddressExpression& expression);
+
+  /**
+   * @param pointerSize 4 or 8, or 0 to take it from the executable of the target (default)
+   * @throw MedException if the size is not supported
+   */
+  void setPointerSize(int pointerSize);
+  int getPointerSize(); // Size used for the current target
+
+  unsigned long getGeneration(); // Maps generation of the cached module bases
+  size_t getBatchCount(); // Number of reads done, for tests
+
+private:
+  Address getModuleBase(const string& module);
+  int currentPointerSize(); // With the mutex locked
+
+  MemIO* memio;
+  MapsTracker tracker;
+  Maps maps;
+  unsigned long generation;
+  std::map<string, Address> moduleBases;
+  size_t batchCount;
+  int pointerSize; // 0 if detected from the target
+  int targetPointerSize;
+  pid_t targetPid; // Pid of targetPointerSize, -1 if not detected yet
+  std::mutex mutex;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef DAEMON_CLIENT_HPP
+#define DAEMON_CLIENT_HPP
+
+#include <string>
+
+#include "mem/DaemonProtocol.hpp"
+#include "med/MedTypes.hpp"
+
+using namespace std;
+
+// Scan results mapped from the memfd of the daemon, read-only, no copy
+class DaemonResults {
+public:
+  DaemonResults();
+  DaemonResults(int fd, size_t count);
+  DaemonResults(DaemonResults&& other);
+  DaemonResults& operator=(DaemonResults&& other);
+  DaemonResults(const DaemonResults&) = delete;
+  DaemonResults& operator=(const DaemonResults&) = delete;
+  ~DaemonResults();
+
+  size_t size();
+  const DaemonResult& operator[](size_t index);
+
+private:
+  void release();
+  const DaemonResult* results;
+  size_t count;
+  size_t mappedSize;
+};
+
+/**
+ * Connection to med-daemon. All the methods throw MedException
+ * if the daemon is not reachable or the request fails.
+ */
+class DaemonClient {
+public:
+  explicit DaemonClient(const string& socketPath = getDaemonSocketPath());
+  ~DaemonClient();
+
+  void open(pid_t pid);
+  void close(pid_t pid); // Drops the session in the daemon
+
+  DaemonResults scan(pid_t pid, const string& value, const string& scanType);
+  DaemonResults filter(pid_t pid, const string& value, const string& scanType);
+  DaemonResults getResults(pid_t pid);
+
+  string read(pid_t pid, Address addr, size_t size);
+  void write(pid_t pid, Address addr, const string& bytes);
+  void freeze(pid_t pid, Address addr, const string& value, const string& scanType);
+  bool unfreeze(pid_t pid, Address addr);
+
+private:
+  DaemonResponse request(DaemonCommand command, pid_t pid, const string& payload, string& response, int* fd = NULL);
+  DaemonResults requestResults(DaemonCommand command, pid_t pid, const string& payload);
+
+  int socketFd;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef DAEMON_PROTOCOL_HPP
+#define DAEMON_PROTOCOL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+using namespace std;
+
+// med-daemon protocol over a Unix domain socket, native endian, local only.
+// Each request is a DaemonRequest followed by the payload, each response is a
+// DaemonResponse followed by the payload. Scan results are not in the payload,
+// they are in a sealed memfd passed with SCM_RIGHTS, as DaemonResult[count].
+
+const char DAEMON_MAGIC[4] = {'M', 'E', 'D', 'D'};
+const uint32_t DAEMON_MAX_PAYLOAD = 16 * 1024 * 1024;
+const string DAEMON_SOCKET_NAME = "med.sock";
+
+enum class DaemonCommand : uint32_t {
+  Open = 1, // Creates the session of the pid, other commands also create it
+  Close,
+  Scan, // Payload: scan type, '\0', scan expression. Response: results fd
+  Filter, // Same as Scan
+  Results, // Response: results fd of the active scan
+  Read, // Payload: DaemonRange. Response payload: the bytes
+  Write, // Payload: uint64_t address, bytes
+  Freeze, // Payload: uint64_t address, scan type, '\0', value
+  Unfreeze // Payload: uint64_t address
+};
+
+enum class DaemonStatus : uint32_t {
+  Ok = 0,
+  Error // Payload: message
+};
+
+struct DaemonRequest {
+  char magic[4];
+  uint32_t command; // DaemonCommand
+  int32_t pid;
+  uint32_t size; // Payload
+};
+
+struct DaemonResponse {
+  uint32_t status; // DaemonStatus
+  uint32_t size; // Payload
+  uint64_t count; // Results in the fd, if any
+};
+
+struct DaemonRange {
+  uint64_t address;
+  uint64_t size;
+};
+
+struct DaemonResult {
+  uint64_t address;
+  uint32_t size;
+  uint32_t scanType; // ScanType
+};
+
+// $XDG_RUNTIME_DIR/med.sock, or /tmp/med-<uid>.sock
+string getDaemonSocketPath();
+
+/**
+ * Header and payload in one message, with an optional fd.
+ * @return false if the peer is closed
+ */
+bool sendDaemonMessage(int socket, const void* header, size_t headerSize, const string& payload, int fd = -1);
+
+// Header first, for the payload size. The fd, if any, comes with the header.
+bool receiveDaemonHeader(int socket, void* header, size_t headerSize, int* fd = NULL);
+bool receiveDaemonPayload(int socket, string& payload, size_t size);
+
+#endif
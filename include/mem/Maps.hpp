@@ -1,3 +1,7 @@
+#ifndef MAPS_HPP
+#define MAPS_HPP
+
+#include <string>
 #include <vector>
 #include <utility>
 
@@ -5,14 +9,56 @@
 
 using namespace std;
 
+// One line of /proc/[pid]/maps
+struct MapRegion {
+  Address start;
+  Address end;
+  bool readable;
+  bool writable;
+  bool executable;
+  bool shared;
+  Address offset; // Offset in the file
+  string device;
+  unsigned long inode;
+  string pathname; // Empty for anonymous mapping
+
+  size_t size() const;
+  bool isAnonymous() const;
+  string getModuleName() const; // Base name of the pathname
+};
+
+// Regions sorted by the start address, so that the address lookup is O(log n).
+// The pairs are kept in parallel for the scanners.
 class Maps {
 public:
   Maps();
   AddressPairs& getMaps();
+  vector<MapRegion>& getRegions();
   bool hasPair(const AddressPair& pair);
   void push(const AddressPair& pair);
+  void push(const MapRegion& region);
   size_t size();
 
+  /**
+   * @return index of the region containing the address, -1 if none
+   */
+  int findRegion(Address address);
+  MapRegion* getRegion(Address address);
+
+  Maps selectModule(const string& name); // By the base name or the full pathname
+  Address getModuleBase(const string& name); // Start of the first region, 0 if not found
+
+  /**
+   * Parts of the regions which are not covered by "other", e.g. newly mapped memory.
+   * The regions are clipped, the permissions and pathname are kept.
+   */
+  Maps subtract(Maps& other);
+
+  static Maps parse(const string& content);
+
 private:
   AddressPairs maps;
+  vector<MapRegion> regions;
 };
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef MAPS_TRACKER_HPP
+#define MAPS_TRACKER_HPP
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "mem/Maps.hpp"
+
+using namespace std;
+
+const int MAPS_CHECK_INTERVAL = 500; // milliseconds
+
+// Follows /proc/[pid]/maps of the target.
+// The file is re-read at most every MAPS_CHECK_INTERVAL, and only parsed when the
+// content differs, so it can be polled from every tick.
+// The generation is increased on each change, results derived from the maps can
+// be cached with the generation they were made from.
+class MapsTracker {
+public:
+  MapsTracker();
+
+  /**
+   * @param force re-read even if the interval is not passed
+   * @return true if the maps changed, or the pid changed
+   */
+  bool update(pid_t pid, bool force = false);
+
+  Maps getMaps(); // Copy, as it may be replaced by another thread
+  unsigned long getGeneration();
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  pid_t pid;
+  string content;
+  Maps maps;
+  unsigned long generation;
+  Clock::time_point checked;
+  std::mutex mutex;
+};
+
+#endif
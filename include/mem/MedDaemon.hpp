@@ -0,0 +1,56 @@
+#ifndef MED_DAEMON_HPP
+#define MED_DAEMON_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "mem/DaemonProtocol.hpp"
+#include "mem/MemEd.hpp"
+
+using namespace std;
+
+// Keeps one MemEd per pid, so the maps, the results and the frozen values stay warm
+// between the frontends. Each connection has its own thread, the requests of the same
+// pid are serialized by the session.
+class MedDaemon {
+public:
+  explicit MedDaemon(const string& socketPath = getDaemonSocketPath());
+  ~MedDaemon();
+
+  /**
+   * Binds the socket, only the owner can connect.
+   * @throw MedException if the socket cannot be created
+   */
+  void start();
+  void run(); // Accepts until stop()
+  void stop();
+
+  size_t getSessionCount();
+
+private:
+  struct Session {
+    MemEd memed;
+    std::mutex mutex;
+  };
+
+  void serve(int client);
+  DaemonStatus handle(const DaemonRequest& request, const string& payload, string& response, int& resultFd, uint64_t& count);
+  shared_ptr<Session> getSession(pid_t pid);
+  int createResultFd(MemList& list, uint64_t& count); // Sealed memfd of DaemonResult[]
+
+  string socketPath;
+  int listenFd;
+  std::atomic<bool> running;
+  map<pid_t, shared_ptr<Session>> sessions;
+  std::mutex sessionsMutex;
+  set<int> clients; // Connections being served, each by a detached thread
+  std::mutex clientsMutex;
+  std::condition_variable clientsDone;
+};
+
+#endif
@@ -4,10 +4,16 @@
 #include <memory>
 #include "med/MedTypes.hpp"
 
+// Values up to INLINE_SIZE bytes are kept in the object, so that a scan hit
+// does not allocate its data.
 class Mem {
 public:
+  static const size_t INLINE_SIZE = 16;
+
   explicit Mem(size_t size);
   Mem(Address addr, size_t size);
+  Mem(const Mem&) = delete;
+  Mem& operator=(const Mem&) = delete;
   ~Mem();
 
   void dump(bool newline = true);
@@ -22,12 +28,17 @@ public:
   Byte* getData();
 
 protected:
-  Byte* data;
+  void resize(size_t size); // Cleared, unless the size is unchanged
+
+  Byte* data; // Points to inlineData for the small values
   size_t size;
   Address address;
 
 private:
   void initialize(size_t size);
+  void release();
+
+  Byte inlineData[INLINE_SIZE + 1]; // One more for the string terminator
 };
 
 typedef std::shared_ptr<Mem> MemPtr;
@@ -1,6 +1,7 @@
 #ifndef MEM_ED_HPP
 #define MEM_ED_HPP
 
+#include <atomic>
 #include <mutex>
 #include <thread>
 
@@ -9,40 +10,107 @@
 #include "mem/MemScanner.hpp"
 #include "mem/MemList.hpp"
 #include "mem/NamedScans.hpp"
+#include "mem/MemFreezer.hpp"
+#include "mem/MemScheduler.hpp"
+#include "mem/PointerScanner.hpp"
+#include "mem/AddressResolver.hpp"
 #include "med/Process.hpp"
 
 const int LOCK_REFRESH_RATE = 800;
 
-class MemEd {
+const char STORE_TABLE_MAGIC[8] = {'M', 'E', 'D', 'T', 'A', 'B', 'L', 'E'};
+const uint32_t STORE_TABLE_VERSION = 1;
+const string STORE_TABLE_EXTENSION = ".medtable";
+
+// Binary store table, the alternative of the JSON file for the large tables.
+// Same layout rule as the scan session file, see NamedScans.hpp.
+struct StoreTableHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t entryCount;
+  uint64_t entriesOffset; // StoreTableEntry[entryCount]
+  uint64_t textOffset; // Descriptions, expressions and notes, not terminated
+  uint64_t textSize;
+  uint64_t notesOffset; // Relative to textOffset
+  uint64_t notesLength;
+};
+
+struct StoreTableEntry {
+  uint64_t address;
+  uint64_t textOffset; // Description, followed by the expression
+  uint32_t descriptionLength;
+  uint32_t expressionLength; // 0 if no address expression
+  uint32_t scanType; // ScanType
+  uint32_t flags; // 1: locked, not restored, same as the JSON
+};
+
+// Also subscribed to the scheduler before the freezer, so that the store entries
+// with an address expression are resolved at the start of each tick.
+class MemEd : public MemSubscriber {
 public:
   MemEd();
   explicit MemEd(pid_t pid);
   ~MemEd();
   void setPid(pid_t pid);
   pid_t getPid();
+  MemIO* getMemIO();
   vector<MemPtr> scan(const string& value, const string& scanType, bool fastScan = false, const string& lastDigit = "");
   vector<MemPtr> filter(const string& value, const string& scanType, bool fastScan = false);
   NamedScans& getNamedScans();
   MemList getScans();
   void clearScans();
+  ScanStats getLastScanStats(); // Of the last scan, filter or snapshot
+
+  // Exact value filter also scans the regions mapped after the last scan or filter
+  void setScanNewRegions(bool value);
+  bool getScanNewRegions();
   MemList* getStore();
   void addToStoreByIndex(int index);
   void addNewAddress();
+
+  /**
+   * Absolute address, or an expression, e.g. "[[libtest.so+0x10]+0x8]+0x4"
+   * @throw MedException if it is not valid
+   */
+  void setStoreAddress(int index, const string& address);
+  void resolveAddresses(); // Update the store entries which have the address expressions
   MemPtr readMemory(Address addr, size_t size);
   void setValueByAddress(Address addr, const string& value, const string& scanType);
 
+  // Pointer scan, the index is built on the first scan, and rebuilt on demand
+  void buildPointerIndex();
+  vector<PointerPath> scanPointers(Address target, const PointerScanOptions& options = PointerScanOptions());
+  void savePointerMap(const string& filename);
+  void saveSession(const string& filename); // Named scans and the snapshot, see NamedScans::save()
+  void openSession(const string& filename);
+
   // Process
   vector<Process> listProcesses();
   Process selectProcessByIndex(int index);
   vector<Process> processes;
   Process selectedProcess;
 
-  void lockValues();
+  void lockValues(); // Hand the locked entries to the freezer
+  void freezeValue(Address addr, const string& value, const string& scanType); // As a locked store entry
+  bool unfreezeValue(Address addr); // Removes the locked store entries of the address
   bool hasLockValue();
+  void setLockInterval(int ms);
+  int getLockInterval();
+  size_t getLockRevertCount(Address addr);
+  MemScheduler* getScheduler(); // Shared by all the pollers of the target
 
   static void callLockValues(MemEd* med);
 
-  void saveFile(const char* filename);
+  void collect(vector<MemRange>& reads);
+  bool deliver(const MemSegments& results, MemSegments& writes);
+
+  /**
+   * JSON, or the binary table if the filename ends with STORE_TABLE_EXTENSION.
+   * The current values are only for reading the JSON, they are not loaded back.
+   * Opening detects the format by the content.
+   */
+  void saveFile(const char* filename, bool withValues = false);
   void openFile(const char* filename);
   void loadLegacyJson(Json::Value& root);
   void loadJson(Json::Value& root);
@@ -52,8 +120,8 @@ public:
 
   void setScopeStart(Address addr);
   void setScopeEnd(Address addr);
-
-  std::mutex& getScanListMutex();
+  void setRegionPolicy(const RegionPolicy& policy); // Regions to be scanned, see RegionPolicy::preset()
+  RegionPolicy getRegionPolicy();
 
   void resumeProcess();
   void pauseProcess();
@@ -63,14 +131,23 @@ public:
 
 private:
   void initialize();
+  vector<string> readValues(const vector<MemPtr>& list); // One batched read for all
+  void saveTable(const char* filename);
+  bool loadTable(const char* filename); // False if it is not a binary table
   pid_t pid;
   MemScanner* scanner;
   NamedScans namedScans;
   MemList* store;
   std::mutex storeMutex;
   std::thread* lockValueThread;
+  std::atomic<bool> isRunning;
+  MemScheduler* scheduler;
+  PointerScanner* pointerScanner;
+  AddressResolver* resolver;
+  MemFreezer* freezer;
   bool canResumeProcess;
   bool isProcessPaused;
+  bool scanNewRegions;
 
   string notes;
 };
@@ -0,0 +1,51 @@
+#ifndef MEM_FREEZER_HPP
+#define MEM_FREEZER_HPP
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "med/SizedBytes.hpp"
+#include "mem/MemIO.hpp"
+#include "mem/MemScheduler.hpp"
+
+const int FREEZE_INTERVAL = 20; // milliseconds
+
+struct FreezeEntry {
+  Address address;
+  SizedBytes value; // Raw bytes to be written
+};
+
+// Keeps the locked values pinned.
+// Each tick, driven by the MemScheduler, the entries are read together with the
+// other subscribers, and only those which were changed by the target are written back.
+class MemFreezer : public MemSubscriber {
+public:
+  explicit MemFreezer(MemIO* memio);
+
+  void setEntries(const vector<FreezeEntry>& entries);
+  size_t size();
+
+  void collect(vector<MemRange>& reads);
+  bool deliver(const MemSegments& results, MemSegments& writes);
+
+  void tick(); // Standalone read and write back, without the scheduler
+
+  /**
+   * Number of times the target changed the value and it was written back.
+   * High count means the entry is actively fought over.
+   */
+  size_t getRevertCount(Address address);
+
+private:
+  MemIO* memio;
+  vector<FreezeEntry> entries;
+  vector<bool> fresh; // Not delivered since setEntries(), the target still holds the old value
+  vector<FreezeEntry> delivering; // Entries of the current tick, the write buffers
+  vector<bool> deliveringFresh;
+  std::map<Address, size_t> reverts;
+  std::mutex mutex;
+};
+
+#endif
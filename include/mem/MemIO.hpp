@@ -1,9 +1,31 @@
 #ifndef MEM_IO_H
 #define MEM_IO_H
 
+#include <atomic>
+#include <map>
 #include <mutex>
+#include <shared_mutex>
+#include <vector>
 #include "med/MedTypes.hpp"
 #include "mem/Mem.hpp"
+#include "mem/MapsTracker.hpp"
+
+// One element of a batched read or write.
+// "buffer" is owned by the caller, "ok" is filled by the batch.
+struct MemSegment {
+  Address address;
+  Byte* buffer;
+  size_t size;
+  bool ok;
+};
+
+typedef std::vector<MemSegment> MemSegments;
+
+// Interest in a piece of memory, before the buffer is assigned
+struct MemRange {
+  Address address;
+  size_t size;
+};
 
 class MemIO {
 public:
@@ -13,13 +35,46 @@ public:
   MemPtr read(Address addr, size_t size);
   void write(Address addr, MemPtr mem, size_t size = 0);
 
+  /**
+   * Fast path for the hot loops, no attach, no exception.
+   * @return false if it cannot be read
+   */
+  bool read(Address addr, Byte* buffer, size_t size);
+
+  /**
+   * Transfer all segments with as few syscalls as possible, without attaching.
+   * @return number of segments transferred successfully
+   */
+  size_t readBatch(MemSegments& segments);
+  size_t writeBatch(MemSegments& segments);
+
+  // Pages known to be unreadable, kept until /proc/[pid]/maps changes
+  size_t getUnreadableCount();
+  size_t getSkipCount(); // Reads not tried because of the unreadable pages
+  void clearUnreadable();
+
+  size_t getSyscallCount(); // Issued to access the target, since the start
+
 private:
   MemPtr readProcess(Address addr, size_t size);
   MemPtr readDirect(Address addr, size_t size);
   void writeProcess(Address addr, MemPtr mem, size_t size);
   void writeDirect(Address addr, MemPtr mem, size_t size);
+  size_t transferProcess(MemSegments& segments, bool isWrite);
+  size_t transferDirect(MemSegments& segments, bool isWrite);
+
+  bool isUnreadable(Address addr, size_t size);
+  void addUnreadable(Address addr, size_t size);
+  void validateUnreadable();
+
   pid_t pid;
   std::mutex mutex;
+
+  std::map<Address, Address> unreadable; // Page aligned start -> end, not overlapping
+  size_t skipCount;
+  std::shared_mutex unreadableMutex;
+  std::atomic<size_t> syscallCount;
+  MapsTracker mapsTracker;
 };
 
 #endif
@@ -2,22 +2,41 @@
 #define MEM_LIST_HPP
 
 #include <vector>
+#include <memory>
 #include "mem/Mem.hpp"
+#include "mem/MemIO.hpp"
 
 using namespace std;
 
 // List that will use methods from PemPtr and SemPtr
+//
+// The vector is published as a version. Every change swaps in a new vector
+// instead of touching the old one, so a copy of MemList is a stable snapshot
+// that other threads can read without locking.
 class MemList {
 public:
   MemList();
   explicit MemList(vector<MemPtr> list);
+  MemList(const MemList& other);
+  MemList& operator=(const MemList& other);
   size_t size();
   void setList(const vector<MemPtr>& list);
-  vector<MemPtr>& getList();
+  void setList(vector<MemPtr>&& list);
+  const vector<MemPtr>& getList(); // Current version, valid until the owner thread changes the list
   string getAddressAsString(int index);
   Address getAddress(int index);
   string getValue(int index, const string& scanType);
   string getValue(int index);
+
+  /**
+   * Read the values of the rows [first, last] in one batch.
+   * Row which cannot be read is "(invalid)".
+   */
+  vector<string> getValues(int first, int last);
+
+  // Same as above, but the reading is done by the caller, e.g. the MemScheduler
+  vector<MemRange> getRanges(int first, int last);
+  vector<string> getValues(int first, const MemSegments& segments);
   string getScanType(int index);
   void dump(int index, bool newline = true);
 
@@ -40,7 +59,7 @@ public:
   static vector<MemPtr> sortByDescription(vector<MemPtr>& list);
 
 private:
-  vector<MemPtr> list;
+  std::shared_ptr<vector<MemPtr>> list;
 };
 
 #endif
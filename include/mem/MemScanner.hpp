@@ -13,6 +13,9 @@
 #include "med/ScanCommand.hpp"
 #include "mem/Mem.hpp"
 #include "mem/MemIO.hpp"
+#include "mem/ResultArena.hpp"
+#include "mem/MapsTracker.hpp"
+#include "mem/ScanStats.hpp"
 
 using namespace std;
 
@@ -31,6 +34,15 @@ public:
                       bool fastScan = false,
                       int lastDigit = -1);
   vector<MemPtr> scan(ScanCommand &scanCommand);
+
+  // Scan only the given regions, e.g. the regions mapped after the last scan
+  vector<MemPtr> scanRegions(Maps& maps,
+                             Operands& operands,
+                             int size,
+                             const string& scanType,
+                             const ScanParser::OpType& op,
+                             bool fastScan = false,
+                             int lastDigit = -1);
   vector<MemPtr> filter(const vector<MemPtr>& list,
                         Operands& operands,
                         int size,
@@ -46,6 +58,8 @@ public:
                                        const ScanParser::OpType& op);
   vector<MemPtr>& saveSnapshot(const vector<MemPtr>& baseList);
   vector<MemPtr> filterSnapshot(const string& scanType, const ScanParser::OpType& op, bool fastScan = false);
+  vector<MemPtr>& getSnapshot();
+  void setSnapshot(vector<MemPtr>&& snapshot); // Restored from the session file
 
   vector<MemPtr> scanInner(Operands& operands,
                            int size,
@@ -71,10 +85,30 @@ public:
 
   std::mutex& getListMutex();
 
+  void setRegionPolicy(const RegionPolicy& policy);
+  RegionPolicy getRegionPolicy();
+
+  /**
+   * Current maps of the target, re-read now.
+   * @param generation is increased whenever the maps differ from the previous call
+   */
+  Maps trackMaps(unsigned long& generation);
+
+  // Results which are no longer in any readable region, are removed at once
+  static vector<MemPtr> dropUnmapped(const vector<MemPtr>& list, Maps& maps);
+
+  // Of the last scan, filter or snapshot
+  ScanStats getLastStats();
+  void setLastStats(const ScanStats& stats); // When one operation is made of several passes
+
 private:
   void initialize();
+  void beginStats(const char* operation);
+  void endStats(bool threaded);
   Maps getInterestedMaps(Maps& maps, const vector<MemPtr>& list);
   void compareBlocks(vector<MemPtr>& list,
+                     ScanStats& stats,
+                     const ResultArenaPtr& arena,
                      MemPtr& oldBlock,
                      MemPtr& newBlock,
                      const string& scanType,
@@ -100,6 +134,7 @@ private:
   static void scanMap(MemIO* memio,
                       std::mutex& mutex,
                       vector<MemPtr>& list,
+                      ScanStats& stats,
                       Maps& maps,
                       int mapIndex,
                       int fd,
@@ -113,6 +148,7 @@ private:
   static void scanMap(MemIO* memio,
                       std::mutex& mutex,
                       vector<MemPtr>& list,
+                      ScanStats& stats,
                       Maps& maps,
                       int mapIndex,
                       int fd,
@@ -124,11 +160,13 @@ private:
 
   static void saveSnapshotMap(MemIO* memio,
                               vector<MemPtr>& snapshot,
+                              ScanStats& stats,
                               Maps& maps,
                               int mapIndex);
   static void scanPage(MemIO* memio,
-                       std::mutex& mutex,
                        vector<MemPtr>& list,
+                       ScanStats& stats,
+                       const ResultArenaPtr& arena,
                        Byte* page,
                        Address start,
                        Operands& operands,
@@ -138,8 +176,9 @@ private:
                        bool fastScan = false,
                        int lastDigit = -1);
   static void scanPage(MemIO* memio,
-                       std::mutex& mutex,
                        vector<MemPtr>& list,
+                       ScanStats& stats,
+                       const ResultArenaPtr& arena,
                        Byte* page,
                        Address start,
                        ScanCommand &scanCommand);
@@ -147,6 +186,7 @@ private:
   static void filterByChunk(std::mutex& mutex,
                             const vector<MemPtr>& list,
                             vector<MemPtr>& newList,
+                            ScanStats& stats,
                             int listIndex,
                             Operands& operands,
                             int size,
@@ -155,11 +195,13 @@ private:
   static void filterByChunk(std::mutex& mutex,
                             const vector<MemPtr>& list,
                             vector<MemPtr>& newList,
+                            ScanStats& stats,
                             int listIndex,
                             ScanCommand &scanCommand);
   static void filterUnknownByChunk(std::mutex& mutex,
                                    const vector<MemPtr>& list,
                                    vector<MemPtr>& newList,
+                                   ScanStats& stats,
                                    int listIndex,
                                    const string& scanType,
                                    const ScanParser::OpType& op);
@@ -171,7 +213,16 @@ private:
   MemIO* memio;
   vector<MemPtr> snapshot;
   AddressPair* scope;
+  RegionPolicy regionPolicy;
+  MapsTracker mapsTracker;
   std::mutex listMutex;
+
+  ScanStats lastStats;
+  const char* statsOperation;
+  chrono::steady_clock::time_point statsStart;
+  int64_t traceStart; // -1 if not tracing
+  size_t statsSyscalls; // Of the MemIO, when the operation started
+  size_t statsSkips;
 };
 
 #endif
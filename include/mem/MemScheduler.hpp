@@ -0,0 +1,86 @@
+#ifndef MEM_SCHEDULER_HPP
+#define MEM_SCHEDULER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/MemIO.hpp"
+
+const int MIN_SCHEDULE_INTERVAL = 1; // milliseconds
+
+// Consumer of the scheduler, e.g. the freezer, the tree views, the memory editor.
+// Both methods are called from the scheduler thread.
+class MemSubscriber {
+public:
+  virtual ~MemSubscriber() {}
+
+  // Append the ranges to be read on this tick.
+  virtual void collect(vector<MemRange>& reads) = 0;
+
+  /**
+   * Receive the results, in the same order as collected. The buffers are only
+   * valid during the call. Segments appended to "writes" are written after all
+   * subscribers are delivered, so their buffers must outlive the tick.
+   * @return true if the values changed, so that it will be polled faster.
+   */
+  virtual bool deliver(const MemSegments& results, MemSegments& writes) = 0;
+};
+
+// Single loop which polls the target for all subscribers.
+// Each tick, the reads of the due subscribers are coalesced by page and done
+// in one batch, then the writes are done in one batch.
+// The interval of a subscriber is reset to its minimum when its values change,
+// and grows to its maximum while they stay the same.
+class MemScheduler {
+public:
+  explicit MemScheduler(MemIO* memio);
+  ~MemScheduler();
+
+  void subscribe(MemSubscriber* subscriber, int minInterval, int maxInterval);
+  void unsubscribe(MemSubscriber* subscriber);
+  void setInterval(MemSubscriber* subscriber, int minInterval, int maxInterval);
+  int getInterval(MemSubscriber* subscriber); // Current interval, -1 if not subscribed
+  void wake(MemSubscriber* subscriber); // Poll it on the next tick
+
+  void start();
+  void stop();
+
+  void tick(); // Serve the subscribers which are due
+  size_t getSpanCount(); // Number of reads done by the last tick
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Subscription {
+    MemSubscriber* subscriber;
+    int minInterval;
+    int maxInterval;
+    int interval;
+    Clock::time_point due;
+  };
+
+  static void run(MemScheduler* scheduler);
+  void notify();
+  void armTimer();
+  Subscription* find(MemSubscriber* subscriber);
+
+  MemIO* memio;
+  vector<Subscription> subscriptions;
+  std::mutex mutex;
+
+  vector<MemRange> ranges;
+  MemSegments spans;
+  vector<Byte> buffer;
+  size_t spanCount;
+
+  std::atomic<bool> running;
+  int timerFd;
+  int wakeFd;
+  std::thread* thread;
+};
+
+#endif
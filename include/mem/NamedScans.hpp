@@ -1,13 +1,51 @@
 #ifndef NAMED_SCANS_HPP
 #define NAMED_SCANS_HPP
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
 #include "mem/MemList.hpp"
+#include "mem/Maps.hpp"
 
 using namespace std;
 
+const char SCAN_SESSION_MAGIC[8] = {'M', 'E', 'D', 'S', 'C', 'A', 'N', 'S'};
+const uint32_t SCAN_SESSION_VERSION = 1;
+
+// Scan session file, native endian, same layout rule as the pointer map:
+// sections are 8 bytes aligned, so it can be used from the mmap without parsing.
+struct ScanSessionHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t scanCount; // Including the snapshot
+  uint64_t activeIndex;
+  uint64_t scansOffset; // ScanSessionScan[scanCount]
+  uint64_t namesOffset; // Scan names, not terminated
+  uint64_t entriesOffset; // ScanSessionEntry[], the entries of each scan are contiguous
+  uint64_t valuesOffset; // Remembered values, and the snapshot data
+  uint64_t valuesSize;
+};
+
+struct ScanSessionScan {
+  uint64_t nameOffset; // Relative to namesOffset
+  uint32_t nameLength;
+  uint32_t flags; // 1: the snapshot of the scanner, not a named scan
+  uint64_t firstEntry;
+  uint64_t entryCount;
+  uint32_t scanType; // ScanType
+  uint32_t reserved;
+};
+
+struct ScanSessionEntry {
+  uint64_t address;
+  uint32_t size;
+  uint32_t valueSize; // 0 if no value is remembered
+  uint64_t valueOffset; // Relative to valuesOffset
+  uint32_t scanType; // ScanType
+  uint32_t reserved;
+};
+
 class NamedScans {
 public:
   inline static const string DEFAULT = "Default";
@@ -25,11 +63,27 @@ public:
   void setScanType(string type);
   string getScanType();
 
+  // Maps of the target when the active scan was last updated, generation 0 if unknown
+  void setMaps(const Maps& maps, unsigned long generation);
+  Maps& getMaps();
+  unsigned long getMapsGeneration();
+
+  vector<string> getNames();
+
+  /**
+   * Every named scan with its remembered values, and the snapshot of the scanner.
+   * Loading replaces all the scans, without reading the target memory.
+   * @throw MedException if the file cannot be written or is not a session file
+   */
+  void save(const string& filename, const vector<MemPtr>& snapshot = vector<MemPtr>());
+  void load(const string& filename, MemIO* memio, vector<MemPtr>* snapshot = NULL);
+
 private:
   void removeScanTypes(string name);
   map<string, MemList> data;
   string activeName;
   map<string, string> scanTypes;
+  map<string, pair<Maps, unsigned long>> scanMaps;
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include "mem/Mem.hpp"
 #include "mem/MemIO.hpp"
+#include "mem/ResultArena.hpp"
 #include "med/SizedBytes.hpp"
 
 // This is Pem (Process mEMory). Derived from Mem
@@ -14,6 +15,11 @@ public:
 
   string getValue(const string& scanType);
   string getValue();
+
+  // Bytes read to show the value. A string result keeps only the matched length,
+  // the rest of the string is read up to MAX_STRING_SIZE when it is shown.
+  size_t getPreviewSize(const string& scanType);
+  size_t getPreviewSize();
   BytePtr getValuePtr(int n = 0);
   string getScanType();
   void setValue(const string& value, const string& scanType);
@@ -21,14 +27,17 @@ public:
 
   void rememberValue(const string& value, const string& scanType);
   void rememberValue(Byte* value, size_t size);
+  void rememberValue(const SizedBytes& value); // Copy of the value, see SizedBytes for what it shares
   string recallValue(const string& scanType);
   Byte* recallValuePtr();
+  size_t recallValueSize();
 
   MemIO* getMemIO();
   static string bytesToString(Byte* value, const string& scanType);
   static SizedBytes stringToBytes(const string& value, const string& scanType);
 
   static std::shared_ptr<Pem> convertToPemPtr(MemPtr mem, MemIO* memio);
+  static std::shared_ptr<Pem> create(Address addr, size_t size, MemIO* memio, const ResultArenaPtr& arena); // Scan hit
 
 private:
   ScanType scanType;
@@ -0,0 +1,162 @@
+#ifndef POINTER_SCANNER_HPP
+#define POINTER_SCANNER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "med/MedTypes.hpp"
+#include "mem/MemIO.hpp"
+
+using namespace std;
+
+const int POINTER_DEPTH = 4;
+const Address POINTER_MAX_OFFSET = 0x1000;
+const size_t POINTER_MAX_RESULTS = 1000;
+const size_t POINTER_CHUNK_SIZE = 1024 * 1024; // Bytes read at once while indexing
+
+const char POINTER_MAP_MAGIC[8] = {'M', 'E', 'D', 'P', 'T', 'R', 'M', 'P'};
+const uint32_t POINTER_MAP_VERSION = 1;
+
+struct PointerRegion {
+  Address start;
+  Address end;
+  bool writable; // Only writable regions are searched for pointers
+  bool isStatic; // File backed, so it can be found again after restart
+  string name;
+};
+
+// "source" holds the value "target"
+struct PointerEntry {
+  Address target;
+  Address source;
+};
+
+struct PointerScanOptions {
+  int depth = POINTER_DEPTH;
+  Address maxOffset = POINTER_MAX_OFFSET;
+  size_t maxResults = POINTER_MAX_RESULTS;
+  int threads = 0; // 0 for the number of cores
+};
+
+// [[base]+offsets[0]]+offsets[1] ... reaches the target
+struct PointerPath {
+  Address base;
+  string module;
+  Address moduleOffset; // base - start of the module
+  vector<Address> offsets;
+
+  string toString() const;
+};
+
+// Pointer map file, native endian. Sections are 8 bytes aligned,
+// so that the entries can be used directly from the mmap.
+struct PointerMapHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t pointerSize;
+  uint64_t regionCount;
+  uint64_t entryCount;
+  uint64_t regionsOffset; // PointerMapRegion[regionCount]
+  uint64_t namesOffset; // Region names, not terminated
+  uint64_t entriesOffset; // PointerEntry[entryCount], sorted by target
+};
+
+struct PointerMapRegion {
+  uint64_t start;
+  uint64_t end;
+  uint32_t flags; // 1: writable, 2: static
+  uint32_t nameLength;
+  uint64_t nameOffset; // Relative to namesOffset
+};
+
+// A run of the target for the intersection: its pointer map and the target address in that run
+struct PointerRun {
+  string filename;
+  Address target;
+};
+
+/**
+ * Pointer scan in two steps.
+ * First, the reverse index: every aligned pointer in the writable regions,
+ * which points into any of the regions, sorted by the target.
+ * Then, paths are searched backward from the target address to the static
+ * regions, each level looks up the pointers to [address - maxOffset, address].
+ * The index can be saved, and loaded back by mmap without parsing.
+ */
+class PointerScanner {
+public:
+  explicit PointerScanner(MemIO* memio);
+  ~PointerScanner();
+
+  void buildIndex(int pointerSize = sizeof(Address)); // Regions of the MemIO pid
+  void buildIndex(const vector<PointerRegion>& regions, int pointerSize = sizeof(Address));
+  vector<PointerPath> findPaths(Address target, const PointerScanOptions& options = PointerScanOptions());
+
+  /**
+   * Only the paths which are also in "candidates", compared by module, module offset and offsets.
+   * The search is pruned to the offsets of the candidates, so it is not limited by maxResults of the earlier runs.
+   */
+  vector<PointerPath> findPaths(Address target,
+                                const vector<PointerPath>& candidates,
+                                const PointerScanOptions& options = PointerScanOptions());
+
+  void save(const string& filename);
+  void load(const string& filename);
+  void clear();
+
+  /**
+   * Paths which are valid in all the runs. The first run is searched,
+   * then each following run narrows the paths.
+   */
+  static vector<PointerPath> intersect(const vector<PointerRun>& runs,
+                                       const PointerScanOptions& options = PointerScanOptions());
+
+  const PointerEntry* getEntries();
+  vector<PointerRegion>& getRegions();
+  size_t size();
+  int getPointerSize();
+
+  static vector<PointerRegion> loadRegions(pid_t pid);
+
+private:
+  // Offsets of the candidates, reversed as in search()
+  struct PathFilter {
+    set<vector<Address>> prefixes;
+    set<string> keys;
+  };
+
+  void indexChunk(Address start, size_t size, int pointerSize, std::mutex& mutex);
+  void search(Address address,
+              vector<Address>& offsets,
+              int depthLeft,
+              const PointerScanOptions& options,
+              const PathFilter* filter,
+              vector<PointerPath>& results,
+              std::mutex& mutex);
+  int findRegion(Address address);
+  void addPath(Address base,
+               const vector<Address>& offsets,
+               size_t maxResults,
+               const PathFilter* filter,
+               vector<PointerPath>& results,
+               std::mutex& mutex);
+
+  vector<PointerPath> findPaths(Address target, const PointerScanOptions& options, const PathFilter* filter);
+  void unmap();
+
+  MemIO* memio;
+  vector<PointerRegion> regions; // Sorted by start
+  vector<PointerEntry> index; // Sorted by target, then source
+  const PointerEntry* entries; // Either index or the mmap
+  size_t entryCount;
+  int pointerSize;
+  void* mapped;
+  size_t mappedSize;
+  std::atomic<size_t> found;
+};
+
+#endif
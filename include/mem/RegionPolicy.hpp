@@ -0,0 +1,49 @@
+#ifndef REGION_POLICY_HPP
+#define REGION_POLICY_HPP
+
+#include <string>
+#include <vector>
+
+#include "mem/Maps.hpp"
+
+using namespace std;
+
+const string REGION_PRESET_ALL = "all";
+const string REGION_PRESET_PRIVATE = "private";
+const string REGION_PRESET_ANONYMOUS = "anonymous";
+const string REGION_PRESET_HEAP = "heap";
+
+// Which of the readable and writable regions are scanned.
+// The globs are matched against the full pathname, anonymous region has empty pathname.
+struct RegionPolicy {
+  // Both set takes either of them
+  bool anonymousOnly = false; // No pathname at all, e.g. mmap() by malloc
+  bool heapOnly = false; // [heap]
+  bool skipShared = false;
+  vector<string> includes; // If any, the pathname must match one of them
+  vector<string> excludes;
+  size_t minSize = 0;
+  size_t maxSize = 0; // 0 for no limit
+
+  bool accepts(const MapRegion& region) const;
+  Maps select(Maps& maps) const;
+
+  /**
+   * all: every region, as before.
+   * private: no shared mapping, device mapping (e.g. GPU driver) or kernel special, e.g. [vvar].
+   * anonymous: private anonymous regions and [heap].
+   * heap: [heap] only.
+   * @throw MedException if the name is unknown
+   */
+  static RegionPolicy preset(const string& name);
+  static vector<string> getPresetNames();
+
+  /**
+   * Preset followed by the options, e.g. {"private", "+*game*", "-/dev/dri*", "min=0x1000", "max=0x100000"}.
+   * "+" and "-" take a glob of the pathname to include or exclude.
+   * @throw MedException if the preset or an option is unknown, or a size is not a number
+   */
+  static RegionPolicy parse(const vector<string>& args);
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef RESULT_ARENA_HPP
+#define RESULT_ARENA_HPP
+
+#include <memory>
+#include <vector>
+#include "med/MedTypes.hpp"
+
+using namespace std;
+
+const size_t RESULT_ARENA_FIRST_CHUNK = 16 * 1024; // Doubled up to the last chunk size
+const size_t RESULT_ARENA_LAST_CHUNK = 1024 * 1024;
+
+// Bump allocator for the hits of one scan or filter task. The hits are created
+// with allocate_shared, so the Pem and its control block come from the chunks,
+// and nothing is freed per hit. Every hit keeps the arena alive; the chunks are
+// freed together when the last hit of the generation is destroyed.
+// Dropping a generation is still O(n): the list releases every shared_ptr, and
+// each release runs the Pem destructor and decrements the arena reference.
+// Only the per hit free() is saved, see "Pem/drop" in med-microbench.
+// Not thread safe, each worker uses its own arena.
+class ResultArena {
+public:
+  ResultArena();
+  ResultArena(const ResultArena&) = delete;
+  ResultArena& operator=(const ResultArena&) = delete;
+
+  void* allocate(size_t size, size_t alignment);
+  size_t getChunkCount();
+  size_t getBytesUsed();
+
+private:
+  vector<unique_ptr<Byte[]>> chunks;
+  Byte* next;
+  size_t remaining;
+  size_t used;
+};
+
+typedef shared_ptr<ResultArena> ResultArenaPtr;
+
+// Allocator for allocate_shared, deallocation is left to the arena
+template <class T>
+class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(const ResultArenaPtr& arena) : arena(arena) {}
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T*, size_t) {}
+
+  template <class U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena == other.arena;
+  }
+  template <class U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena != other.arena;
+  }
+
+  ResultArenaPtr arena;
+};
+
+#endif
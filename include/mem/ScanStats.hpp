@@ -0,0 +1,41 @@
+#ifndef SCAN_STATS_HPP
+#define SCAN_STATS_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// What the last scan, filter or snapshot did, to tell whether it was I/O, CPU or lock bound.
+// The workers count into their own copy, which is merged together with their results.
+struct ScanStats {
+  string operation; // scan, filter, snapshot, snapshot filter
+  double elapsedMs = 0;
+
+  size_t bytesRequested = 0;
+  size_t bytesRead = 0;
+  size_t pagesRead = 0;
+  size_t pagesUnreadable = 0; // The read failed, e.g. guard pages
+  size_t pagesUnmapped = 0; // Snapshot pages gone before the filter
+  size_t readsSkipped = 0; // Known unreadable pages, not tried again
+  size_t readErrors = 0;
+  size_t syscalls = 0;
+
+  size_t matches = 0;
+  size_t allocations = 0; // Page buffers and result objects
+
+  double listLockWaitMs = 0;
+  double fdLockWaitMs = 0;
+  vector<double> workerBusyMs;
+  vector<double> workerIdleMs;
+
+  void merge(const ScanStats& other);
+
+  string summary() const; // One line, for the status bar
+  string toString() const;
+};
+
+double elapsedMs(const chrono::steady_clock::time_point& start);
+
+#endif
@@ -1,5 +1,6 @@
 #include "mem/Pem.hpp"
 #include "mem/MemIO.hpp"
+#include "mem/AddressResolver.hpp"
 
 // This is Sem (Saved/stored process mEMory). Derived from Pem
 class Sem : public Pem {
@@ -13,8 +14,17 @@ public:
   string getDescription();
   void setDescription(string s);
 
+  // Module relative or pointer chain, the address itself is resolved by MemEd on each tick.
+  // Absolute expression just sets the address.
+  bool hasAddressExpression();
+  AddressExpression& getAddressExpression();
+  void setAddressExpression(const string& expression); // Throws MedException if invalid
+  void clearAddressExpression();
+  void shiftAddress(long diff); // Also the last offset of the expression
+
   void setLockedValue(string s);
   string& getLockedValue();
+  SizedBytes& getLockedBytes(); // Encoded once, so freezing does not parse the string every tick
   void lockValue();
 
   static std::shared_ptr<Sem> clone(shared_ptr<Sem> semPtr);
@@ -23,7 +33,11 @@ public:
 private:
   bool locked;
   string description;
+  bool hasExpression;
+  AddressExpression addressExpression;
   string lockedValue;
+  SizedBytes lockedBytes;
+  string lockedScanType;
 };
 
 typedef std::shared_ptr<Sem> SemPtr;
@@ -1,8 +1,11 @@
 #ifndef MEM_EDITOR_HPP
 #define MEM_EDITOR_HPP
 
+#include <atomic>
 #include <string>
+#include <vector>
 #include <QWidget>
+#include <QByteArray>
 #include <QLineEdit>
 #include <QPlainTextEdit>
 #include <QPushButton>
@@ -14,7 +17,8 @@
 const int MEMORY_SIZE = 384; // 12 lines
 const int ADDRESS_LINE = 24;
 
-class MemEditor : public QWidget {
+// While shown, the memory is polled by the MemScheduler
+class MemEditor : public QWidget, public MemSubscriber {
   Q_OBJECT
 
 public:
@@ -33,7 +37,18 @@ public:
 
   void boldText();
 
+  void collect(vector<MemRange>& reads);
+  bool deliver(const MemSegments& results, MemSegments& writes);
+
+signals:
+  void memoryRead(quint64 address, QByteArray memory);
+
+protected:
+  void showEvent(QShowEvent* event) Q_DECL_OVERRIDE;
+  void hideEvent(QHideEvent* event) Q_DECL_OVERRIDE;
+
 private slots:
+  void onMemoryRead(quint64 address, QByteArray memory);
   void onCurrAddressEdited();
   void onMemAreaCursorPositionChanged();
   void onRefreshButtonClicked();
@@ -60,9 +75,15 @@ private:
 
   Byte* rawMemory; // For re-use without keep read from PID
 
+  std::atomic<Address> watchedAddress;
+  // Used by the scheduler thread only
+  Address lastAddress;
+  std::vector<Byte> lastMemory;
+
   void setupSignals();
 
   void loadMemory(Address address, size_t size = MEMORY_SIZE); // 12 lines
+  void showMemory(Byte* memory, size_t size);
   void loadAddresses(Address address, size_t size = ADDRESS_LINE);
 
   void updateCurrAddress();
@@ -12,6 +12,7 @@ class NamedScansController : public QObject {
   Q_OBJECT
 public:
   explicit NamedScansController(MedUi *mainUi);
+  void reload(); // After the named scans are replaced, e.g. by the session file
 private slots:
   void onAddClicked();
   void onDeleteClicked();
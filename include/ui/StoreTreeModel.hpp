@@ -20,7 +20,6 @@ public:
   bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) Q_DECL_OVERRIDE;
   Qt::ItemFlags flags(const QModelIndex &index) const Q_DECL_OVERRIDE;
   void refresh();
-  void refreshValues(); //Refresh values only
   void addRow();
 
   void sortByDescription();
@@ -34,6 +33,7 @@ protected:
 
   bool setItemData(const QModelIndex &index, const QVariant &value);
   QVariant getUtfString(int row, string scanType);
+  MemList getRefreshList();
 };
 
 #endif
@@ -1,9 +1,11 @@
 #ifndef TREEMODEL_H
 #define TREEMODEL_H
 
+#include <atomic>
 #include <QAbstractItemModel>
 #include <QModelIndex>
 #include <QVariant>
+#include <QStringList>
 
 #include "ui/TreeItem.hpp"
 #include "mem/MemEd.hpp"
@@ -18,7 +20,7 @@
 
 class MedUi;
 
-class TreeModel : public QAbstractItemModel {
+class TreeModel : public QAbstractItemModel, public MemSubscriber {
   Q_OBJECT
 public:
   TreeModel(MedUi* mainUi, QObject* parent = 0);
@@ -59,13 +61,27 @@ public:
 
   void addScan(string scanType);
 
-  void refreshValues();
   void empty(); //including the med data
 
+  // Values are polled by the MemScheduler, only the rows in [first, last]
+  void setRefreshRows(int first, int last);
+  void setRefreshPaused(bool paused); // Nothing is read while paused,
+  void requestRefresh();              // except once after requested
+  void setEditing(bool editing); // Refreshed values are dropped while a value is edited
+  void collect(vector<MemRange>& reads);
+  bool deliver(const MemSegments& results, MemSegments& writes);
+
   TreeItem* root();
   MedUi* mainUi;
   MemEd* med;
 
+signals:
+  void valuesRead(int first, QStringList values, int generation);
+  void valueEdited(const QModelIndex& index); // By setData(), unlike the refresh
+
+private slots:
+  void onValuesRead(int first, QStringList values, int generation);
+
 protected:
   void setupModelData(const QStringList &lines, TreeItem* parent);
 
@@ -79,6 +95,24 @@ protected:
   QVariant getUtfString(int row, string scanType);
   string encodeString(const string& str, const string& scanType);
   string convertToUtf8(const string& str, const string& scanType);
+
+  virtual MemList getRefreshList(); // Snapshot of the list shown
+  int valueColumn;
+
+  std::atomic<int> refreshFirst;
+  std::atomic<int> refreshLast;
+  std::atomic<bool> refreshPaused;
+  std::atomic<bool> refreshRequested;
+  std::atomic<int> generation; // Changed when the rows are removed, so that the queued values are dropped
+  std::atomic<bool> editing;
+  std::atomic<bool> valuesDropped; // Delivered again after the edit, even if unchanged
+
+  // Used by the scheduler thread only
+  MemList refreshList;
+  int refreshFrom;
+  int refreshGeneration;
+  vector<string> lastValues;
+  int lastFrom;
 };
 
 #endif // TREEMODEL_H
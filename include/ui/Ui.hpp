@@ -23,7 +23,9 @@
 #include "ui/NamedScansController.hpp"
 #include "mem/MemEd.hpp"
 
-const int REFRESH_RATE = 800;
+const int REFRESH_RATE = 800; // Slowest, when the values do not change
+const int MIN_REFRESH_RATE = 200;
+const int REFRESH_MARGIN = 20; // Rows refreshed beyond the visible area
 
 const QString MAIN_TITLE = "Med UI";
 
@@ -51,27 +53,25 @@ public:
   StoreTreeModel* storeModel;
   TreeModel* scanModel;
 
-  static void refresh(MedUi* mainUi);
-  void refreshScanTreeView();
-  void refreshStoreTreeView();
+  void updateRefreshRows(QTreeView* view, TreeModel* model);
 
   EncodingManager* encodingManager;
   MemEd* med;
   bool autoRefresh;
   bool fastScan;
-  std::thread* refreshThread;
 
   UiState getScanState();
   void setScanState(UiState);
   UiState getStoreState();
   void setStoreState(UiState);
 
-  std::mutex* scanUpdateMutex;
+  std::mutex scanUpdateMutex; // Guards the scan tree model only, scans publish results without it
   std::mutex storeUpdateMutex;
 
   void setWindowTitle();
   void openFile(QString filename);
   void updateNumberOfAddresses();
+  void showScanStats(); // Summary of the last scan, filter or snapshot
 
 public slots:
   void onProcessItemDblClicked(QTreeWidgetItem* item, int column);
@@ -88,8 +88,8 @@ private slots:
   void onStoreTreeViewDoubleClicked(const QModelIndex &index);
   void onStoreTreeViewClicked(const QModelIndex &index);
 
-  void onScanTreeViewDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles = QVector<int>());
-  void onStoreTreeViewDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles = QVector<int>());
+  void onScanValueEdited(const QModelIndex& index);
+  void onStoreValueEdited(const QModelIndex& index);
 
   void onScanAddClicked();
   void onScanAddAllClicked();
@@ -107,13 +107,18 @@ private slots:
   void onSaveTriggered();
   void onOpenTriggered();
   void onReloadTriggered();
+  void onSaveSessionTriggered();
+  void onOpenSessionTriggered();
   void onQuitTriggered();
   void onShowNotesTriggered(bool checked);
   void onNotesAreaChanged();
   void onAutoRefreshTriggered(bool checked);
   void onRefreshTriggered();
+  void onScanTreeViewScrolled();
+  void onStoreTreeViewScrolled();
   void onResumeProcessTriggered(bool checked);
   void onFastScanTriggered(bool checked);
+  void onScanNewRegionsTriggered(bool checked);
 
   void onNewAddressTriggered();
   void onDeleteAddressTriggered();
@@ -123,6 +128,7 @@ private slots:
 
   void onScopeStartEdited();
   void onScopeEndEdited();
+  void onRegionPolicyChanged(QString name);
 
 private:
   void loadUiFiles();
@@ -135,6 +141,7 @@ private:
   void setupUi();
 
   string getLastDigit();
+  pair<int, int> getVisibleRows(QTreeView* view);
 
   QApplication* app;
   UiState scanState;
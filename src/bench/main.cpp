@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <json/json.h>
+
+#include "mem/MemEd.hpp"
+#include "mem/MemFreezer.hpp"
+#include "mem/StringUtil.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+#include "med/ScanParser.hpp"
+
+using namespace std;
+
+// med-bench [--target <path>] [--runs N] [--bench name,...] [--baseline <file>] [--record <file>] [-- <target options>]
+// Starts med-bench-target, see target.cpp for its options, and measures the
+// operations against it. Each benchmark is one JSON line on stdout.
+//
+// With --baseline, the tracked metrics are compared with the file, and the exit
+// status is 2 if any of them regressed more than its tolerance, in percent:
+// {"tolerance": 20, "benchmarks": {"scan": {"gbps": 0.5, "tolerance": 30}}}
+// The metrics ending with "_ms" are better when lower, the others when higher.
+// --record writes the file from this run, with the main metric of each benchmark.
+
+const double DEFAULT_TOLERANCE = 20;
+
+struct BenchResult {
+  string name;
+  vector<double> samples; // Milliseconds per run
+  double bytes = 0; // Per run, for the throughput
+  double ops = 0; // Per run, e.g. the entries refreshed
+  size_t results = 0;
+};
+
+struct Target {
+  pid_t pid = 0;
+  Json::Value info;
+};
+
+static double percentile(vector<double> samples, double p) {
+  sort(samples.begin(), samples.end());
+  size_t rank = (size_t)ceil(p * samples.size());
+  return samples[max(rank, (size_t)1) - 1];
+}
+
+static map<string, double> metrics(const BenchResult& result) {
+  double p50 = percentile(result.samples, 0.5);
+  map<string, double> values = {
+    { "p50_ms", p50 },
+    { "p99_ms", percentile(result.samples, 0.99) }
+  };
+  if (result.bytes) {
+    values["gbps"] = result.bytes / (p50 / 1000) / 1e9;
+  }
+  if (result.ops) {
+    values["ops_per_s"] = result.ops / (p50 / 1000);
+  }
+  return values;
+}
+
+static void report(const BenchResult& result) {
+  double p50 = percentile(result.samples, 0.5);
+  printf("{\"bench\":\"%s\",\"runs\":%zu,\"p50_ms\":%.3f,\"p99_ms\":%.3f,\"min_ms\":%.3f",
+         result.name.c_str(), result.samples.size(), p50, percentile(result.samples, 0.99),
+         *min_element(result.samples.begin(), result.samples.end()));
+  if (result.bytes) {
+    printf(",\"bytes\":%.0f,\"gbps\":%.3f", result.bytes, result.bytes / (p50 / 1000) / 1e9);
+  }
+  if (result.ops) {
+    printf(",\"ops\":%.0f,\"ops_per_s\":%.0f", result.ops, result.ops / (p50 / 1000));
+  }
+  printf(",\"results\":%zu}\n", result.results);
+  fflush(stdout);
+}
+
+static double measure(const function<void()>& run) {
+  auto start = chrono::steady_clock::now();
+  run();
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+static Target startTarget(const string& path, const vector<string>& args) {
+  int fds[2];
+  if (pipe(fds) == -1) {
+    throw MedException("Failed to create pipe");
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[0]);
+    close(fds[1]);
+    vector<char*> argv = { (char*)path.c_str() };
+    for (auto& arg : args) {
+      argv.push_back((char*)arg.c_str());
+    }
+    argv.push_back(NULL);
+    execv(path.c_str(), argv.data());
+    perror(path.c_str());
+    _exit(127);
+  }
+  close(fds[1]);
+
+  // The target prints its layout when the memory is ready
+  FILE* output = fdopen(fds[0], "r");
+  char* line = NULL;
+  size_t length = 0;
+  bool ready = getline(&line, &length, output) > 0;
+  Target target;
+  target.pid = pid;
+  if (ready) {
+    istringstream(line) >> target.info;
+  }
+  free(line);
+  fclose(output);
+  if (!ready) {
+    waitpid(pid, NULL, 0);
+    throw MedException("Target did not start: " + path);
+  }
+  return target;
+}
+
+static size_t scannedBytes(MemEd& memed, pid_t pid) {
+  Maps all = getAllMaps(pid);
+  Maps maps = selectMaps(all, memed.getRegionPolicy());
+  size_t total = 0;
+  for (auto& region : maps.getRegions()) {
+    total += region.size();
+  }
+  return total;
+}
+
+static void benchSnapshot(MemEd& memed, Target& target, int runs, const function<void(const BenchResult&)>& add) {
+
+  // Unknown value scan of the churn region, which keeps changing.
+  // Filtering the unchanged values keeps the results small, it measures the comparison.
+  Address churnStart = hexToInt(target.info["churnStart"].asString());
+  Address churnEnd = hexToInt(target.info["churnEnd"].asString());
+  memed.setScopeStart(churnStart);
+  memed.setScopeEnd(churnEnd);
+  BenchResult snapshot;
+  snapshot.name = "snapshot";
+  snapshot.bytes = churnEnd - churnStart;
+  BenchResult snapshotFilter;
+  snapshotFilter.name = "snapshot-filter";
+  snapshotFilter.bytes = snapshot.bytes;
+  for (int i = 0; i < runs; i++) {
+    snapshot.samples.push_back(measure([&] { memed.scan("?", SCAN_TYPE_INT_32); }));
+    snapshotFilter.samples.push_back(measure([&] {
+      snapshotFilter.results = memed.filter("=", SCAN_TYPE_INT_32).size();
+    }));
+  }
+  memed.setScopeStart(0);
+  memed.setScopeEnd(0);
+  add(snapshot);
+  add(snapshotFilter);
+}
+
+static void benchPointers(MemEd& memed, Target& target, int runs, const function<void(const BenchResult&)>& add) {
+  BenchResult pointerIndex;
+  pointerIndex.name = "pointer-index";
+  pointerIndex.samples.push_back(measure([&] { memed.buildPointerIndex(); }));
+  add(pointerIndex);
+
+  BenchResult pointerScan;
+  pointerScan.name = "pointer-scan";
+  PointerScanOptions options;
+  options.depth = target.info["depth"].asInt() + 1;
+  options.maxOffset = 0x100;
+  Address chainTarget = hexToInt(target.info["chainTarget"].asString());
+  for (int i = 0; i < runs; i++) {
+    pointerScan.samples.push_back(measure([&] {
+      pointerScan.results = memed.scanPointers(chainTarget, options).size();
+    }));
+  }
+  add(pointerScan);
+}
+
+static vector<BenchResult> runBenchmarks(Target& target, int runs, const set<string>& only) {
+  auto isSelected = [&only](const string& name) {
+    return only.empty() || only.count(name);
+  };
+  vector<BenchResult> results;
+  auto add = [&](const BenchResult& result) {
+    if (isSelected(result.name)) {
+      report(result);
+      results.push_back(result);
+    }
+  };
+
+  MemEd memed;
+  memed.setPid(target.pid);
+  string value = to_string(target.info["value"].asInt());
+
+  BenchResult scan;
+  scan.name = "scan";
+  scan.bytes = scannedBytes(memed, target.pid);
+  for (int i = 0; i < runs; i++) {
+    scan.samples.push_back(measure([&] { scan.results = memed.scan(value, SCAN_TYPE_INT_32).size(); }));
+  }
+  add(scan); // The other benchmarks work on its results
+
+  if (isSelected("filter")) {
+    BenchResult filter;
+    filter.name = "filter";
+    filter.ops = scan.results;
+    for (int i = 0; i < runs; i++) {
+      filter.samples.push_back(measure([&] { filter.results = memed.filter(value, SCAN_TYPE_INT_32).size(); }));
+    }
+    add(filter);
+  }
+
+  // Same reads as the UI refreshing the visible rows
+  MemList scans = memed.getScans();
+  if (isSelected("refresh")) {
+    BenchResult refresh;
+    refresh.name = "refresh";
+    refresh.ops = scans.size();
+    refresh.results = scans.size();
+    for (int i = 0; i < runs; i++) {
+      refresh.samples.push_back(measure([&] {
+        for (size_t first = 0; first < scans.size(); first += 4096) {
+          scans.getValues(first, first + 4095);
+        }
+      }));
+    }
+    add(refresh);
+  }
+
+  if (isSelected("freeze")) {
+    BenchResult freeze;
+    freeze.name = "freeze";
+    MemFreezer freezer(memed.getMemIO());
+    vector<FreezeEntry> entries;
+    for (auto& mem : scans.getList()) {
+      entries.push_back({ mem->getAddress(), ScanParser::valueToBytes(value, SCAN_TYPE_INT_32) });
+    }
+    freezer.setEntries(entries);
+    freeze.ops = entries.size();
+    freeze.results = entries.size();
+    for (int i = 0; i < runs; i++) {
+      freeze.samples.push_back(measure([&] { freezer.tick(); }));
+    }
+    add(freeze);
+  }
+
+  if (isSelected("snapshot") || isSelected("snapshot-filter")) {
+    benchSnapshot(memed, target, runs, add);
+  }
+  if (isSelected("pointer-index") || isSelected("pointer-scan")) {
+    benchPointers(memed, target, runs, add);
+  }
+  return results;
+}
+
+/**
+ * One JSON line per tracked metric.
+ * @return false if any metric regressed beyond its tolerance, or is missing
+ */
+static bool compareBaseline(const vector<BenchResult>& results, const string& filename) {
+  Json::Value baseline;
+  ifstream file(filename);
+  if (!file || !(file >> baseline)) {
+    throw MedException("Failed to read baseline: " + filename);
+  }
+  double tolerance = baseline.get("tolerance", DEFAULT_TOLERANCE).asDouble();
+
+  bool passed = true;
+  auto& benchmarks = baseline["benchmarks"];
+  for (auto& name : benchmarks.getMemberNames()) {
+    auto& tracked = benchmarks[name];
+    auto result = find_if(results.begin(), results.end(), [&name](const BenchResult& r) { return r.name == name; });
+    map<string, double> values;
+    if (result != results.end()) {
+      values = metrics(*result);
+    }
+
+    double allowed = tracked.get("tolerance", tolerance).asDouble();
+    for (auto& metric : tracked.getMemberNames()) {
+      if (metric == "tolerance") continue;
+      double expected = tracked[metric].asDouble();
+      bool found = values.count(metric);
+      double actual = found ? values[metric] : 0;
+
+      // Positive when worse
+      bool isLowerBetter = metric.size() > 3 && metric.compare(metric.size() - 3, 3, "_ms") == 0;
+      double change = (isLowerBetter ? actual - expected : expected - actual) / expected * 100;
+      bool regressed = !found || change > allowed;
+      passed = passed && !regressed;
+      printf("{\"baseline\":\"%s\",\"metric\":\"%s\",\"value\":%.3f,\"expected\":%.3f,"
+             "\"regression_pct\":%.1f,\"tolerance_pct\":%.1f,\"regressed\":%s}\n",
+             name.c_str(), metric.c_str(), actual, expected, change, allowed, regressed ? "true" : "false");
+    }
+  }
+  fflush(stdout);
+  return passed;
+}
+
+// The main metric of each benchmark: the throughput, or the latency if there is none
+static void recordBaseline(const vector<BenchResult>& results, const string& filename) {
+  Json::Value baseline;
+  baseline["tolerance"] = DEFAULT_TOLERANCE;
+  baseline["benchmarks"] = Json::objectValue;
+  for (auto& result : results) {
+    auto values = metrics(result);
+    string metric = values.count("gbps") ? "gbps" : values.count("ops_per_s") ? "ops_per_s" : "p50_ms";
+    baseline["benchmarks"][result.name][metric] = values[metric];
+  }
+
+  ofstream file(filename);
+  Json::StyledStreamWriter writer("  ");
+  writer.write(file, baseline);
+  if (!file) {
+    throw MedException("Failed to write baseline: " + filename);
+  }
+}
+
+int main(int argc, char** argv) {
+  string directory = argv[0];
+  directory = directory.find('/') == string::npos ? "." : directory.substr(0, directory.rfind('/'));
+  string targetPath = directory + "/med-bench-target";
+  int runs = 5;
+  set<string> only;
+  string baselineFile;
+  string recordFile;
+  vector<string> targetArgs;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--") == 0) {
+      targetArgs.assign(argv + i + 1, argv + argc);
+      break;
+    }
+    else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc) targetPath = argv[++i];
+    else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) runs = max(atoi(argv[++i]), 1);
+    else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+      for (auto& name : StringUtil::split(argv[++i], ',')) {
+        only.insert(name);
+      }
+    }
+    else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baselineFile = argv[++i];
+    else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordFile = argv[++i];
+    else {
+      cerr << "Usage: med-bench [--target <path>] [--runs N] [--bench name,...] "
+           << "[--baseline <file>] [--record <file>] [-- <target options>]" << endl;
+      return 1;
+    }
+  }
+
+  Target target;
+  bool passed = true;
+  try {
+    target = startTarget(targetPath, targetArgs);
+    Json::FastWriter writer;
+    string info = writer.write(target.info); // With the newline
+    printf("{\"target\":%s}\n", info.substr(0, info.size() - 1).c_str());
+    auto results = runBenchmarks(target, runs, only);
+
+    if (recordFile.size()) {
+      recordBaseline(results, recordFile);
+    }
+    if (baselineFile.size()) {
+      passed = compareBaseline(results, baselineFile);
+    }
+  } catch(MedException& ex) {
+    cerr << ex.getMessage() << endl;
+    if (target.pid) {
+      kill(target.pid, SIGKILL);
+      waitpid(target.pid, NULL, 0);
+    }
+    return 1;
+  }
+
+  kill(target.pid, SIGKILL);
+  waitpid(target.pid, NULL, 0);
+  return passed ? 0 : 2;
+}
@@ -0,0 +1,262 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "med/MedCommon.hpp"
+#include "med/MemOperator.hpp"
+#include "med/ScanCommand.hpp"
+#include "med/ScanParser.hpp"
+#include "med/SubCommand.hpp"
+#include "mem/Pem.hpp"
+
+using namespace std;
+
+// med-microbench [filter]
+// Inner loop primitives on fixed datasets, one JSON line per benchmark with
+// ns/op and allocations/op. Only the benchmarks containing the filter are run.
+
+static std::atomic<size_t> allocations(0);
+
+// Every replaced new and delete goes through this pair, so the compiler
+// does not pair free() with operator new (-Wmismatched-new-delete)
+static void* allocate(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = ::malloc(size ? size : 1);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+static void release(void* ptr) noexcept {
+  ::free(ptr);
+}
+
+void* operator new(size_t size) {
+  return allocate(size);
+}
+
+void* operator new[](size_t size) {
+  return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  release(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  release(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  release(ptr);
+}
+
+const size_t DATA_SIZE = 64 * 1024;
+const double MIN_DURATION_MS = 200; // Per benchmark, after the warm up
+
+static volatile size_t sink; // Keeps the results alive
+static string filter;
+
+/**
+ * Runs the body, which performs "batch" operations, until MIN_DURATION_MS.
+ */
+static void bench(const string& name, size_t batch, const function<size_t()>& body) {
+  if (name.find(filter) == string::npos) return;
+
+  sink = body(); // Warm up, and the one-off allocations are not counted
+  size_t ops = 0;
+  size_t allocs = allocations;
+  auto start = chrono::steady_clock::now();
+  chrono::duration<double, milli> elapsed(0);
+  while (elapsed.count() < MIN_DURATION_MS) {
+    sink = body();
+    ops += batch;
+    elapsed = chrono::steady_clock::now() - start;
+  }
+  allocs = allocations - allocs;
+
+  printf("{\"bench\":\"%s\",\"ops\":%zu,\"ns_per_op\":%.2f,\"allocs_per_op\":%.2f}\n",
+         name.c_str(), ops, elapsed.count() * 1e6 / ops, (double)allocs / ops);
+  fflush(stdout);
+}
+
+/**
+ * Times only dropping the list which "build" returns, ns/op is per entry.
+ * Repeated until MIN_DURATION_MS of dropping, the building is not timed.
+ */
+static void benchDrop(const string& name, const function<vector<MemPtr>()>& build) {
+  if (name.find(filter) == string::npos) return;
+
+  size_t ops = 0;
+  size_t allocs = 0;
+  chrono::duration<double, milli> elapsed(0);
+  while (elapsed.count() < MIN_DURATION_MS) {
+    vector<MemPtr> list = build();
+    size_t count = list.size();
+    size_t before = allocations;
+    auto start = chrono::steady_clock::now();
+    vector<MemPtr>().swap(list);
+    elapsed += chrono::steady_clock::now() - start;
+    allocs += allocations - before;
+    ops += count;
+  }
+
+  printf("{\"bench\":\"%s\",\"ops\":%zu,\"ns_per_op\":%.2f,\"allocs_per_op\":%.2f}\n",
+         name.c_str(), ops, elapsed.count() * 1e6 / ops, (double)allocs / ops);
+  fflush(stdout);
+}
+
+static const char* opName(ScanParser::OpType op) {
+  static const char* names[] = { "Eq", "Gt", "Lt", "Neq", "Ge", "Le" };
+  return names[op];
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) filter = argv[1];
+
+  // Small values, so that every comparison has both outcomes
+  vector<Byte> data(DATA_SIZE);
+  mt19937 random(1);
+  for (auto& byte : data) {
+    byte = random() % 4;
+  }
+  Byte* bytes = data.data();
+  const Byte operand[8] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+  const Byte low[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+  const Byte high[8] = { 2, 2, 2, 2, 2, 2, 2, 2 };
+
+  for (size_t width : { 1, 2, 4, 8 }) {
+    size_t count = DATA_SIZE / width;
+    for (auto op : { ScanParser::Eq, ScanParser::Gt, ScanParser::Lt, ScanParser::Neq, ScanParser::Ge, ScanParser::Le }) {
+      bench(string("memCompare/") + opName(op) + "/" + to_string(width), count, [&] {
+        size_t matched = 0;
+        for (size_t i = 0; i < count; i++) {
+          matched += memCompare(bytes + i * width, operand, width, op);
+        }
+        return matched;
+      });
+    }
+    bench("memWithin/" + to_string(width), count, [&] {
+      size_t matched = 0;
+      for (size_t i = 0; i < count; i++) {
+        matched += memWithin(bytes + i * width, low, high, width);
+      }
+      return matched;
+    });
+  }
+
+  // Operands version, used by the scan with the parsed value
+  Operands operands = ScanParser::valueToOperands("1", SCAN_TYPE_INT_32);
+  bench("memCompare/Operands/4", DATA_SIZE / 4, [&] {
+    size_t matched = 0;
+    for (size_t i = 0; i < DATA_SIZE / 4; i++) {
+      matched += memCompare(bytes + i * 4, 4, operands, ScanParser::Eq);
+    }
+    return matched;
+  });
+
+  vector<pair<string, string>> commands = {
+    { "int", "1" },
+    { "string", "s:'ab'" },
+    { "wildcard", "s:'a', w:2, s:'b'" }
+  };
+  for (auto& command : commands) {
+    ScanCommand scanCommand(command.second);
+    size_t count = DATA_SIZE - scanCommand.getSize();
+    bench("ScanCommand::match/" + command.first, count, [&] {
+      size_t matched = 0;
+      for (size_t i = 0; i < count; i++) {
+        matched += scanCommand.match(bytes + i);
+      }
+      return matched;
+    });
+    bench("SubCommand/" + command.first, 1, [&] {
+      return SubCommand(command.second.substr(0, command.second.find(','))).getSize();
+    });
+  }
+
+  vector<tuple<string, string, string, ScanParser::OpType>> values = {
+    { "int32", "12345", SCAN_TYPE_INT_32, ScanParser::Eq },
+    { "float32", "1.5", SCAN_TYPE_FLOAT_32, ScanParser::Eq },
+    { "hex", "0x3039", SCAN_TYPE_INT_32, ScanParser::Eq },
+    { "within", "10 20", SCAN_TYPE_INT_32, ScanParser::Within },
+    { "string", "hello", SCAN_TYPE_STRING, ScanParser::Eq }
+  };
+  for (auto& value : values) {
+    bench("valueToOperands/" + get<0>(value), 1, [&] {
+      return ScanParser::valueToOperands(get<1>(value), get<2>(value), get<3>(value)).count();
+    });
+  }
+
+  // A scan hit, as created by the scanner
+  for (auto& type : { SCAN_TYPE_INT_32, SCAN_TYPE_STRING }) {
+    bench("Pem/hit/" + type, 1, [&] {
+      PemPtr pem(new Pem((Address)bytes, 4, NULL));
+      pem->setScanType(type);
+      pem->rememberValue(bytes, 4);
+      return pem->getSize();
+    });
+  }
+  // Hits of a scan task, from the same arena, then freed together
+  const size_t HITS = 4096;
+  bench("Pem/hit/arena/" + SCAN_TYPE_INT_32, HITS, [&] {
+    ResultArenaPtr arena = make_shared<ResultArena>();
+    vector<MemPtr> hits;
+    hits.reserve(HITS);
+    for (size_t i = 0; i < HITS; i++) {
+      PemPtr pem = Pem::create((Address)(bytes + i), 4, NULL, arena);
+      pem->setScanType(SCAN_TYPE_INT_32);
+      pem->rememberValue(bytes + i, 4);
+      hits.push_back(pem);
+    }
+    return hits.size();
+  });
+
+  // Dropping a whole generation of results, e.g. when the next scan replaces it.
+  // Both are O(n), every shared_ptr is released; the arena only saves the frees.
+  const size_t DROP_HITS = 5 * 1000 * 1000;
+  benchDrop("Pem/drop/" + SCAN_TYPE_INT_32, [&] {
+    vector<MemPtr> hits;
+    hits.reserve(DROP_HITS);
+    for (size_t i = 0; i < DROP_HITS; i++) {
+      hits.push_back(PemPtr(new Pem((Address)(bytes + i % DATA_SIZE), 4, NULL)));
+    }
+    return hits;
+  });
+  benchDrop("Pem/drop/arena/" + SCAN_TYPE_INT_32, [&] {
+    ResultArenaPtr arena = make_shared<ResultArena>();
+    vector<MemPtr> hits;
+    hits.reserve(DROP_HITS);
+    for (size_t i = 0; i < DROP_HITS; i++) {
+      hits.push_back(Pem::create((Address)(bytes + i % DATA_SIZE), 4, NULL, arena));
+    }
+    return hits;
+  });
+
+  Byte buffer[8];
+  for (auto& type : { SCAN_TYPE_INT_8, SCAN_TYPE_INT_32, SCAN_TYPE_FLOAT_64 }) {
+    ScanType scanType = stringToScanType(type);
+    bench("stringToMemory/" + type, 1, [&] {
+      stringToMemory("42", scanType, buffer);
+      return (size_t)buffer[0];
+    });
+    bench("hexStringToMemory/" + type, 1, [&] {
+      hexStringToMemory("0x2a", scanType, buffer);
+      return (size_t)buffer[0];
+    });
+    bench("memToString/" + type, 1, [&] {
+      return memToString(bytes, type).size();
+    });
+  }
+
+  return 0;
+}
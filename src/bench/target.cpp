@@ -0,0 +1,126 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/mman.h>
+
+using namespace std;
+
+// Synthetic target of med-bench.
+// med-bench-target [--size-mb N] [--density N] [--value N] [--strings N] [--chains N] [--depth N] [--churn N] [--seed N]
+//
+// Fills N MiB of anonymous memory with random bytes, plants the int32 value
+// "density" times per MiB, and the string "MEDBENCH" "strings" times in total.
+// Pointer chains start from a static array, so that the pointer scan has a static base.
+// Churn threads keep writing to a separate region, like a game updating its state.
+// When ready, prints one JSON line with the addresses and waits to be killed.
+
+const int32_t DEFAULT_VALUE = 0x4d454442; // Not likely to appear in the random bytes by chance
+const char PLANTED_STRING[] = "MEDBENCH";
+const size_t CHUNK_SIZE = 64 << 20; // One mapping per chunk, more than one region to scan
+const size_t NODE_SIZE = 64;
+const size_t NODE_NEXT = 0x10; // Offset of the next pointer in the node
+const size_t NODE_VALUE = 0x8; // Offset of the value in the last node
+const int MAX_CHAINS = 64;
+
+void* chainRoots[MAX_CHAINS]; // Static base of the chains
+std::atomic<bool> churning(true);
+
+static long argument(int argc, char** argv, const string& name, long defaultValue) {
+  for (int i = 1; i + 1 < argc; i++) {
+    if (name == argv[i]) return strtol(argv[i + 1], NULL, 0);
+  }
+  return defaultValue;
+}
+
+static void churn(int32_t* region, size_t count) {
+  size_t i = 0;
+  while (churning) {
+    region[i % count]++;
+    i += 7919; // Prime stride, touches the whole region
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t sizeMb = argument(argc, argv, "--size-mb", 256);
+  size_t density = argument(argc, argv, "--density", 16);
+  int32_t value = argument(argc, argv, "--value", DEFAULT_VALUE);
+  size_t strings = argument(argc, argv, "--strings", 1024);
+  int chains = min((int)argument(argc, argv, "--chains", 16), MAX_CHAINS);
+  int depth = argument(argc, argv, "--depth", 3);
+  int churnThreads = argument(argc, argv, "--churn", 1);
+  mt19937_64 random(argument(argc, argv, "--seed", 1));
+
+  size_t total = sizeMb << 20;
+  vector<pair<uint8_t*, size_t>> chunks;
+  for (size_t done = 0; done < total; done += CHUNK_SIZE) {
+    size_t size = min(CHUNK_SIZE, total - done);
+    void* chunk = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (chunk == MAP_FAILED) {
+      perror("mmap");
+      return 1;
+    }
+    // Random, but every byte has the high bit, so the default value and the string
+    // never appear by chance and the number of the results is exact
+    uint64_t* words = (uint64_t*)chunk;
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++) {
+      words[i] = random() | 0x8080808080808080ULL;
+    }
+    chunks.push_back({ (uint8_t*)chunk, size });
+  }
+
+  auto randomAddress = [&](size_t size, size_t align) {
+    auto& chunk = chunks[random() % chunks.size()];
+    size_t offset = random() % (chunk.second - size);
+    return chunk.first + offset - offset % align;
+  };
+
+  // Strings first, the values may overwrite them but not the other way round
+  for (size_t i = 0; i < strings; i++) {
+    memcpy(randomAddress(sizeof(PLANTED_STRING), 1), PLANTED_STRING, sizeof(PLANTED_STRING) - 1);
+  }
+  size_t planted = 0;
+  for (size_t i = 0; i < sizeMb * density; i++) {
+    int32_t* slot = (int32_t*)randomAddress(sizeof(int32_t), sizeof(int32_t));
+    if (*slot != value) {
+      *slot = value;
+      planted++;
+    }
+  }
+
+  // roots[i] -> node -> ... -> last node, the value is at NODE_VALUE of the last node
+  void* chainTarget = NULL;
+  for (int i = 0; i < chains; i++) {
+    uint8_t* node = (uint8_t*)calloc(1, NODE_SIZE);
+    chainRoots[i] = node;
+    for (int level = 1; level < depth; level++) {
+      uint8_t* next = (uint8_t*)calloc(1, NODE_SIZE);
+      *(void**)(node + NODE_NEXT) = next;
+      node = next;
+    }
+    *(int32_t*)(node + NODE_VALUE) = value + 1;
+    if (i == 0) chainTarget = node + NODE_VALUE;
+  }
+
+  size_t churnCount = 1 << 20;
+  vector<int32_t> churnRegion(churnCount, 0);
+  vector<std::thread> threads;
+  for (int i = 0; i < churnThreads; i++) {
+    threads.push_back(std::thread(churn, churnRegion.data(), churnCount));
+  }
+
+  printf("{\"pid\":%d,\"sizeMb\":%zu,\"value\":%d,\"planted\":%zu,\"strings\":%zu,"
+         "\"chains\":%d,\"depth\":%d,\"chainTarget\":\"%p\",\"chainRoot\":\"%p\","
+         "\"churnStart\":\"%p\",\"churnEnd\":\"%p\"}\n",
+         getpid(), sizeMb, value, planted, strings, chains, depth, chainTarget, (void*)chainRoots,
+         (void*)churnRegion.data(), (void*)(churnRegion.data() + churnCount));
+  fflush(stdout);
+
+  for (;;) pause();
+  return 0;
+}
@@ -0,0 +1,200 @@
+#include <chrono>
+#include <cstdio>
+
+#include <json/json.h>
+
+#include "cli/BatchRunner.hpp"
+#include "mem/StringUtil.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+BatchRunner::BatchRunner(MemEd* memed, FILE* output, BatchFormat format) {
+  this->memed = memed;
+  this->output = output;
+  this->format = format;
+  lineNumber = 0;
+  lastScanType = SCAN_TYPE_INT_32;
+  fastScan = false;
+}
+
+BatchFormat BatchRunner::stringToFormat(const string& format) {
+  if (format == "jsonl") return BatchFormat::JsonLines;
+  else if (format == "csv") return BatchFormat::Csv;
+  throw MedException(string("Unknown output format: ") + format);
+}
+
+int BatchRunner::run(istream& script) {
+  writeHeader();
+
+  string line;
+  while (getline(script, line)) {
+    lineNumber++;
+    line = StringUtil::trim(line);
+    if (line.empty() || line[0] == '#') continue;
+
+    size_t space = line.find(' ');
+    string command = line.substr(0, space);
+    string args = space == string::npos ? "" : StringUtil::trim(line.substr(space + 1));
+
+    auto start = chrono::steady_clock::now();
+    try {
+      size_t count = runCommand(command, args);
+      chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+      writeCommand(command, args, count, elapsed.count());
+    } catch(MedException &ex) {
+      writeError(command, args, ex.getMessage());
+      fflush(output);
+      return 1;
+    } catch(std::exception &ex) { // e.g. invalid number
+      writeError(command, args, ex.what());
+      fflush(output);
+      return 1;
+    }
+    fflush(output);
+  }
+  return 0;
+}
+
+size_t BatchRunner::runCommand(const string& command, const string& args) {
+  vector<string> splitted = StringUtil::split(args, ' ');
+
+  if (command == "scan") {
+    return scan(args, false);
+  }
+  else if (command == "filter") {
+    return scan(args, true);
+  }
+  else if (command == "snapshot") {
+    memed->scan("?", lastScanType, fastScan);
+    return 0;
+  }
+  else if (command == "scope") {
+    if (splitted.size() == 0) {
+      memed->setScopeStart(0);
+      memed->setScopeEnd(0);
+    }
+    else if (splitted.size() == 2) {
+      memed->setScopeStart(hexToInt(splitted[0]));
+      memed->setScopeEnd(hexToInt(splitted[1]));
+    }
+    else {
+      throw MedException("Usage: scope [<start> <end>]");
+    }
+    return 0;
+  }
+  else if (command == "region") {
+    memed->setRegionPolicy(RegionPolicy::parse(splitted));
+    return 0;
+  }
+  else if (command == "named") {
+    auto& namedScans = memed->getNamedScans();
+    string name = args.size() ? args : NamedScans::DEFAULT;
+    namedScans.addNewScan(name);
+    namedScans.setActiveName(name);
+    return namedScans.getMemList()->size();
+  }
+  else if (command == "fast") {
+    fastScan = args == "on";
+    return 0;
+  }
+  else if (command == "count") {
+    return memed->getNamedScans().getMemList()->size();
+  }
+  else if (command == "list") {
+    return list(args);
+  }
+  throw MedException(string("Unknown command: ") + command);
+}
+
+string BatchRunner::checkScanType(const string& scanType) {
+  if (stringToScanType(scanType) == ScanType::Unknown) {
+    throw MedException(string("Unknown scan type: ") + scanType);
+  }
+  return scanType;
+}
+
+// <type> <expression>
+size_t BatchRunner::scan(const string& args, bool isFilter) {
+  size_t space = args.find(' ');
+  if (space == string::npos) {
+    throw MedException("Usage: scan|filter <type> <expression>");
+  }
+  string scanType = checkScanType(args.substr(0, space));
+  string value = StringUtil::trim(args.substr(space + 1));
+  lastScanType = scanType;
+
+  vector<MemPtr> mems = isFilter ? memed->filter(value, scanType, fastScan) : memed->scan(value, scanType, fastScan);
+  return mems.size();
+}
+
+size_t BatchRunner::list(const string& args) {
+  MemList scans = memed->getScans(); // Stable version, even if it is replaced
+  size_t total = scans.size();
+  if (args.size()) {
+    total = min(total, (size_t)stoul(args));
+  }
+
+  for (size_t first = 0; first < total; first += BATCH_LIST_CHUNK) {
+    int last = min(total, first + BATCH_LIST_CHUNK) - 1;
+    vector<string> values = scans.getValues(first, last);
+    for (size_t i = 0; i < values.size(); i++) {
+      writeResult(scans.getAddressAsString(first + i), values[i], scans.getScanType(first + i));
+    }
+  }
+  return total;
+}
+
+string BatchRunner::quote(const string& str) {
+  if (format == BatchFormat::JsonLines) {
+    return Json::valueToQuotedString(str.c_str());
+  }
+  if (str.find_first_of(",\"\r\n") == string::npos) {
+    return str;
+  }
+  string quoted = "\"";
+  for (char c : str) {
+    if (c == '"') quoted += '"';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void BatchRunner::writeHeader() {
+  if (format == BatchFormat::Csv) {
+    fprintf(output, "event,line,command,args,count,ms,address,value,type,message\n");
+  }
+}
+
+void BatchRunner::writeCommand(const string& command, const string& args, size_t count, double ms) {
+  if (format == BatchFormat::JsonLines) {
+    fprintf(output, "{\"event\":\"command\",\"line\":%zu,\"command\":%s,\"args\":%s,\"count\":%zu,\"ms\":%.3f}\n",
+            lineNumber, quote(command).c_str(), quote(args).c_str(), count, ms);
+  }
+  else {
+    fprintf(output, "command,%zu,%s,%s,%zu,%.3f,,,,\n",
+            lineNumber, quote(command).c_str(), quote(args).c_str(), count, ms);
+  }
+}
+
+void BatchRunner::writeResult(const string& address, const string& value, const string& scanType) {
+  if (format == BatchFormat::JsonLines) {
+    fprintf(output, "{\"event\":\"result\",\"address\":\"%s\",\"value\":%s,\"type\":\"%s\"}\n",
+            address.c_str(), quote(value).c_str(), scanType.c_str());
+  }
+  else {
+    fprintf(output, "result,%zu,,,,,%s,%s,%s,\n", lineNumber, address.c_str(), quote(value).c_str(), scanType.c_str());
+  }
+}
+
+void BatchRunner::writeError(const string& command, const string& args, const string& message) {
+  if (format == BatchFormat::JsonLines) {
+    fprintf(output, "{\"event\":\"error\",\"line\":%zu,\"command\":%s,\"args\":%s,\"message\":%s}\n",
+            lineNumber, quote(command).c_str(), quote(args).c_str(), quote(message).c_str());
+  }
+  else {
+    fprintf(output, "error,%zu,%s,%s,,,,,,%s\n",
+            lineNumber, quote(command).c_str(), quote(args).c_str(), quote(message).c_str());
+  }
+}
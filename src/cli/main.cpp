@@ -1,5 +1,7 @@
 #include <iostream>
+#include <fstream>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <readline/readline.h>
@@ -10,13 +12,26 @@
 #include <unistd.h>
 #include <signal.h>
 
+#include "cli/BatchRunner.hpp"
 #include "mem/StringUtil.hpp"
 #include "mem/MemScanner.hpp"
 #include "mem/MemEd.hpp"
+#include "med/MedException.hpp"
+#include "med/Tracer.hpp"
 
 #define COMMAND_SCAN 1
 #define COMMAND_FILTER 2
 #define COMMAND_LIST 3
+#define COMMAND_POINTER 4
+#define COMMAND_POINTER_INDEX 5
+#define COMMAND_POINTER_SAVE 6
+#define COMMAND_POINTER_INTERSECT 7
+#define COMMAND_REGION 8
+#define COMMAND_NEW_REGIONS 9
+#define COMMAND_SESSION_SAVE 10
+#define COMMAND_SESSION_OPEN 11
+#define COMMAND_STATS 12
+#define COMMAND_TRACE 13
 
 using namespace std;
 
@@ -28,6 +43,16 @@ MemEd* memed;
 int interpretCommand(const string& command) {
   if (command == "s") return COMMAND_SCAN;
   else if (command == "f") return COMMAND_FILTER;
+  else if (command == "p") return COMMAND_POINTER;
+  else if (command == "pi") return COMMAND_POINTER_INDEX;
+  else if (command == "ps") return COMMAND_POINTER_SAVE;
+  else if (command == "px") return COMMAND_POINTER_INTERSECT;
+  else if (command == "r") return COMMAND_REGION;
+  else if (command == "n") return COMMAND_NEW_REGIONS;
+  else if (command == "ss") return COMMAND_SESSION_SAVE;
+  else if (command == "so") return COMMAND_SESSION_OPEN;
+  else if (command == "st") return COMMAND_STATS;
+  else if (command == "tr") return COMMAND_TRACE;
   return COMMAND_LIST;
 }
 
@@ -41,12 +66,96 @@ void filter(const string& value) {
   printf("Filtered %zu\n", mems.size());
 }
 
+// p <address> [depth] [max offset] [max results]
+void scanPointers(const vector<string>& args) {
+  if (args.size() < 2) {
+    cerr << "Usage: p <address> [depth] [max offset] [max results]" << endl;
+    return;
+  }
+  PointerScanOptions options;
+  if (args.size() > 2) options.depth = stoi(args[2]);
+  if (args.size() > 3) options.maxOffset = hexToInt(args[3]);
+  if (args.size() > 4) options.maxResults = stoul(args[4]);
+
+  vector<PointerPath> paths = memed->scanPointers(hexToInt(args[1]), options);
+  for (auto& path : paths) {
+    cout << path.toString() << endl;
+  }
+  printf("Found %zu\n", paths.size());
+}
+
+// px <file> <address> [<file> <address> ...]
+// The maps are saved by "ps" in the earlier runs, the address is the target in that run.
+void intersectPointers(const vector<string>& args) {
+  if (args.size() < 3 || args.size() % 2 == 0) {
+    cerr << "Usage: px <file> <address> [<file> <address> ...]" << endl;
+    return;
+  }
+  vector<PointerRun> runs;
+  for (size_t i = 1; i + 1 < args.size(); i += 2) {
+    runs.push_back({ args[i], (Address)hexToInt(args[i + 1]) });
+  }
+
+  vector<PointerPath> paths = PointerScanner::intersect(runs);
+  for (auto& path : paths) {
+    cout << path.toString() << endl;
+  }
+  printf("Found %zu\n", paths.size());
+}
+
+// r <preset> [+glob] [-glob] [min=size] [max=size]
+// Without argument, shows the presets and the regions to be scanned.
+void setRegionPolicy(const vector<string>& args) {
+  if (args.size() < 2) {
+    for (auto& name : RegionPolicy::getPresetNames()) {
+      cout << name << " ";
+    }
+    cout << endl;
+
+    Maps maps = getMaps(g_pid, memed->getRegionPolicy());
+    size_t total = 0;
+    for (auto& region : maps.getRegions()) {
+      total += region.size();
+    }
+    printf("Regions %zu, %zu bytes\n", maps.size(), total);
+    return;
+  }
+
+  RegionPolicy policy = RegionPolicy::parse(vector<string>(args.begin() + 1, args.end()));
+  memed->setRegionPolicy(policy);
+}
+
+// tr <file> starts tracing, tr writes the trace to the file
+void trace(const vector<string>& args) {
+  static string file;
+  Tracer& tracer = Tracer::get();
+  if (args.size() > 1) {
+    file = args[1];
+    tracer.start();
+    return;
+  }
+  if (file.empty()) {
+    cerr << "Usage: tr <file>, then tr to write it" << endl;
+    return;
+  }
+  tracer.stop();
+  try {
+    tracer.save(file);
+    printf("Traced %zu events to %s\n", tracer.size(), file.c_str());
+  } catch(MedException& ex) {
+    cerr << ex.getMessage() << endl;
+  }
+}
+
 void showList() {
   auto scans = memed->getScans();
-  for (size_t i = 0; i < scans.size(); i++) {
-    cout << scans.getAddressAsString(i) << "\t";
-    scans.dump(i, false);
-    cout << scans.getValue(i) << endl;
+  for (size_t first = 0; first < scans.size(); first += BATCH_LIST_CHUNK) {
+    vector<string> values = scans.getValues(first, first + BATCH_LIST_CHUNK - 1);
+    for (size_t i = 0; i < values.size(); i++) {
+      cout << scans.getAddressAsString(first + i) << "\t";
+      scans.dump(first + i, false);
+      cout << values[i] << endl;
+    }
   }
 }
 
@@ -62,6 +171,69 @@ void interpretLine(string command) {
   else if (cmd == COMMAND_FILTER) {
     filter(splitted[1]);
   }
+  else if (cmd == COMMAND_POINTER) {
+    try {
+      scanPointers(splitted);
+    } catch(MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    } catch(std::exception& ex) { // e.g. invalid depth or result count
+      cerr << "Error input: " << ex.what() << endl;
+    }
+  }
+  else if (cmd == COMMAND_POINTER_INDEX) {
+    memed->buildPointerIndex();
+  }
+  else if (cmd == COMMAND_POINTER_SAVE && splitted.size() > 1) {
+    try {
+      memed->savePointerMap(splitted[1]);
+    } catch(MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    }
+  }
+  else if (cmd == COMMAND_POINTER_INTERSECT) {
+    try {
+      intersectPointers(splitted);
+    } catch(MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    }
+  }
+  else if (cmd == COMMAND_REGION) {
+    try {
+      setRegionPolicy(splitted);
+    } catch(MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    }
+  }
+  else if (cmd == COMMAND_NEW_REGIONS) {
+    // n [on|off], exact value filter also scans the newly mapped regions
+    if (splitted.size() > 1) {
+      memed->setScanNewRegions(splitted[1] == "on");
+    }
+    printf("Scan new regions: %s\n", memed->getScanNewRegions() ? "on" : "off");
+  }
+  else if (cmd == COMMAND_SESSION_SAVE && splitted.size() > 1) {
+    try {
+      memed->saveSession(splitted[1]);
+    } catch(MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    }
+  }
+  else if (cmd == COMMAND_SESSION_OPEN && splitted.size() > 1) {
+    // so <file>, restores all the named scans, the active one is listed
+    try {
+      memed->openSession(splitted[1]);
+      printf("Loaded %zu\n", memed->getScans().size());
+    } catch(MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    }
+  }
+  else if (cmd == COMMAND_STATS) {
+    // st, what the last scan, filter or snapshot spent its time on
+    cout << memed->getLastScanStats().toString();
+  }
+  else if (cmd == COMMAND_TRACE) {
+    trace(splitted);
+  }
   else {
     showList();
   }
@@ -78,10 +250,40 @@ void handler(int sig) {
   exit(1);
 }
 
+// --batch <script|-> [--format jsonl|csv], results to stdout
+int runBatch(int argc, char** argv) {
+  string script;
+  string format = "jsonl";
+  for (int i = 2; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--batch") == 0) script = argv[i + 1];
+    else if (strcmp(argv[i], "--format") == 0) format = argv[i + 1];
+  }
+
+  int ret;
+  try {
+    BatchRunner runner(memed, stdout, BatchRunner::stringToFormat(format));
+    if (script == "-") {
+      ret = runner.run(cin);
+    }
+    else {
+      ifstream ifs(script);
+      if (ifs.fail()) {
+        throw MedException("Failed to open " + script);
+      }
+      ret = runner.run(ifs);
+    }
+  } catch(MedException& ex) {
+    cerr << ex.getMessage() << endl;
+    ret = 1;
+  }
+  delete memed;
+  return ret;
+}
+
 int main(int argc, char** argv) {
   if (argc < 2) {
     cerr << "Missing argument\n"
-      "Usage: med-cli [pid]" << endl;
+      "Usage: med-cli [pid] [--batch <script|-> [--format jsonl|csv]]" << endl;
     return -1;
   }
   signal(SIGSEGV, handler);
@@ -89,6 +291,10 @@ int main(int argc, char** argv) {
   g_pid = stol(string(argv[1]));
   memed = new MemEd(g_pid);
 
+  if (argc > 3) {
+    return runBatch(argc, argv);
+  }
+
   char shellPrompt[PROMPT_BUFFER];
   cout << "Med CLI" <<endl;
   rl_bind_key('\t', rl_complete);
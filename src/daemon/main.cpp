@@ -0,0 +1,41 @@
+#include <iostream>
+#include <cstring>
+#include <csignal>
+#include <thread>
+
+#include "mem/MedDaemon.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+// med-daemon [--socket <path>]
+// Serves until SIGINT or SIGTERM, see DaemonProtocol.hpp for the requests.
+int main(int argc, char** argv) {
+  string socketPath = getDaemonSocketPath();
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--socket") == 0) socketPath = argv[i + 1];
+  }
+
+  // Handled by sigwait() below, also blocked in the serving threads
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+  MedDaemon daemon(socketPath);
+  try {
+    daemon.start();
+  } catch(MedException& ex) {
+    cerr << ex.getMessage() << endl;
+    return 1;
+  }
+  cout << "Listening on " << socketPath << endl;
+
+  std::thread server(&MedDaemon::run, &daemon);
+  int sig;
+  sigwait(&signals, &sig);
+  daemon.stop();
+  server.join();
+  return 0;
+}
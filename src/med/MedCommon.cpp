@@ -1,5 +1,7 @@
 #include <iostream>
 #include <sstream>
+#include <cerrno>
+#include <cstdlib> //strtol()
 #include <cstring> //strerror()
 #include <fstream>
 #include <regex>
@@ -8,6 +10,7 @@
 #include <sys/ptrace.h> //ptrace()
 #include <sys/wait.h> //waitpid()
 #include <dirent.h> //read directory
+#include <elf.h> //ELFCLASS32
 #include <signal.h> // kill
 
 #include "med/MedCommon.hpp"
@@ -42,11 +45,12 @@ int hexStrToInt(const string& str) {
 /**
  * @brief Convert hexadecimal string to integer value
  */
-long hexToInt(string str) {
-  stringstream ss(str);
-  long ret = -1;
-  ss >> hex >> ret;
-  if(ss.fail()) {
+long hexToInt(const string& str) {
+  // Same as reading with std::hex, without the stream for every address of a table
+  char* end;
+  errno = 0;
+  long ret = strtol(str.c_str(), &end, 16);
+  if (end == str.c_str() || errno == ERANGE) {
     throw MedException(string("Error input: ") + str);
   }
 
@@ -175,47 +179,61 @@ void printHex(FILE* file,void* addr,int size) {
   }
 }
 
-Maps getMaps(pid_t pid) {
-  Maps maps;
+string getMapsContent(pid_t pid) {
+  char filename[128];
+  if (pid) {
+    sprintf(filename, "/proc/%d/maps", pid);
+  }
+  else {
+    sprintf(filename, "/proc/self/maps"); // Same as MemIO, which reads its own memory
+  }
+  ifstream file(filename);
+  if (!file.is_open()) {
+    throw MedException(string("Failed open maps: ") + filename);
+  }
+  stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
 
-  //Get the region from /proc/pid/maps
+int getPointerSize(pid_t pid) {
   char filename[128];
-  sprintf(filename,"/proc/%d/maps",pid);
-  FILE* file;
-  file = fopen(filename,"r");
-  if(!file) {
-    printf("Failed open maps: %s\n",filename);
-    exit(1);
+  if (pid) {
+    sprintf(filename, "/proc/%d/exe", pid);
+  }
+  else {
+    sprintf(filename, "/proc/self/exe");
   }
+  unsigned char ident[EI_NIDENT] = {0};
+  ifstream file(filename, ios::binary);
+  file.read((char*)ident, sizeof(ident));
+  if (file && memcmp(ident, ELFMAG, SELFMAG) == 0 && ident[EI_CLASS] == ELFCLASS32) {
+    return 4;
+  }
+  return sizeof(Address);
+}
 
-  char useless[64];
-  Address start, end;
-  char rd, wr;
-  unsigned int inode;
-  char sp; //shared or private
-  char fname[128];
+Maps getAllMaps(pid_t pid) {
+  return Maps::parse(getMapsContent(pid));
+}
 
-  //Get line
-  char line[256];
+Maps getMaps(pid_t pid) {
+  return getMaps(pid, RegionPolicy());
+}
 
-  while (fgets(line, 255, file)) {
-    //parse line
-    //the empty pathname has to be scan also
-    if (sscanf(line, "%lx-%lx %c%c%c%c %8s %5s %u %127s",
-              &start, &end,
-              &rd, &wr, useless, &sp,
-              useless, useless, &inode, fname) < 9) {
-      continue;
-    }
+Maps getMaps(pid_t pid, const RegionPolicy& policy) {
+  Maps all = getAllMaps(pid);
+  return selectMaps(all, policy);
+}
 
-    if (rd == 'r' && wr == 'w' && ((end - start) > 0)) {
-      AddressPair pair(start, end);
-      maps.push(pair);
+Maps selectMaps(Maps& all, const RegionPolicy& policy) {
+  Maps maps;
+  //the empty pathname has to be scan also
+  for (auto& region : all.getRegions()) {
+    if (region.readable && region.writable && region.size() > 0 && policy.accepts(region)) {
+      maps.push(region);
     }
   }
-
-  fclose(file);
-
   return maps;
 }
 
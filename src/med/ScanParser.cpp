@@ -99,13 +99,13 @@ SizedBytes ScanParser::numericToBytes(const string& v, const string& t) {
   }
 
   int valueLength = scanTypeToSize(t);
-  BytePtr data(new Byte[valueLength * values.size()]);
-  Byte* pointer = data.get();
+  SizedBytes data = SizedBytes::create(valueLength * values.size());
+  Byte* pointer = data.getBytes();
   for (size_t i = 0; i < values.size(); i++) {
     stringToMemory(values[i], t, pointer);
     pointer += valueLength;
   }
-  return SizedBytes(data, valueLength * values.size());
+  return data;
 }
 
 SizedBytes ScanParser::stringToBytes(const string& v) {
@@ -115,16 +115,7 @@ SizedBytes ScanParser::stringToBytes(const string& v) {
   }
   int valueLength = v.size();
 
-  BytePtr data(new Byte[valueLength]);
-
-  char* pointer = (char*)data.get();
-  char buf[2];
-  for (int i = 0; i < (int)v.size(); i++, pointer++) {
-    sprintf(buf, "%c", v[i]);
-    memcpy(pointer, buf, 1);
-  }
-
-  return SizedBytes(data, valueLength);
+  return SizedBytes((const Byte*)v.data(), valueLength);
 }
 
 bool ScanParser::isSnapshotOperator(const OpType& opType) {
@@ -162,11 +153,9 @@ Operands ScanParser::getTwoOperands(const string& v, const string& t) {
 
   vector<SizedBytes> list;
   for (int i = 0; i < 2; i++) {
-    BytePtr data(new Byte[length]);
-    Byte* ptr = data.get();
-    stringToMemory(values[i], t, ptr);
-
-    list.push_back(SizedBytes(data, length));
+    SizedBytes data = SizedBytes::create(length);
+    stringToMemory(values[i], t, data.getBytes());
+    list.push_back(data);
   }
   return Operands(list);
 }
@@ -2,37 +2,38 @@
 #include "med/SizedBytes.hpp"
 
 SizedBytes::SizedBytes() {
-  BytePtr data(NULL);
-  this->data = std::make_pair(data, 0);
+  size = 0;
 }
 
-SizedBytes::SizedBytes(Byte* bytes, int length) {
-  Byte* newBytes = new Byte[length];
-  memcpy(newBytes, bytes, length);
-  BytePtr data(newBytes);
-  this->data = std::make_pair(data, length);
+SizedBytes::SizedBytes(const Byte* bytes, int length) : SizedBytes(SizedBytes::create(length)) {
+  if (length > 0) {
+    memcpy(getBytes(), bytes, length);
+  }
 }
 
-SizedBytes::SizedBytes(BytePtr data, int length) {
-  this->data = std::make_pair(data, length);
+SizedBytes::SizedBytes(BytePtr data, int length) : data(data) {
+  size = length;
 }
 
 SizedBytes SizedBytes::create(int length) {
+  if ((size_t)length <= INLINE_SIZE) {
+    SizedBytes bytes;
+    bytes.size = length;
+    return bytes;
+  }
   BytePtr bytePtr(new Byte[length]);
   return SizedBytes(bytePtr, length);
 }
 
 size_t SizedBytes::getSize() {
-  return std::get<1>(data);
-}
-
-BytePtr SizedBytes::getBytePtr() {
-  return std::get<0>(data);
+  return size;
 }
 
 Byte* SizedBytes::getBytes() {
-  auto bytePtr = getBytePtr();
-  return bytePtr.get();
+  if (size == 0) {
+    return NULL;
+  }
+  return data ? data.get() : inlineBytes;
 }
 
 bool SizedBytes::isEmpty() {
@@ -1,9 +1,11 @@
+#include <chrono>
 #include <future>
 #include <string>
 #include <iostream>
 #include <condition_variable>
 #include <mutex>
 #include "med/ThreadManager.hpp"
+#include "med/Tracer.hpp"
 
 using namespace std;
 
@@ -11,6 +13,7 @@ ThreadManager::ThreadManager(int maxThreads) {
   this->maxThreads = maxThreads;
   this->numOfRunningThreads = 0;
   this->currThreadIndex = -1;
+  this->elapsedMs = 0;
 }
 
 ThreadManager::~ThreadManager() {}
@@ -36,8 +39,14 @@ void ThreadManager::start() {
   // That is why, store all the futures to the local variable, which will be destroyed at the end of function.
   currThreadIndex = 0;
   vector<future<void>> futures;
+  auto startTime = chrono::steady_clock::now();
 
   unique_lock<mutex> lk(mut);
+  busyMs.assign(maxThreads, 0);
+  freeSlots.clear();
+  for (int i = maxThreads - 1; i >= 0; i--) {
+    freeSlots.push_back(i);
+  }
   while (currThreadIndex < (int)container.size()) {
     if (numOfRunningThreads >= maxThreads) {
       cv.wait(lk, [this] {
@@ -45,22 +54,50 @@ void ThreadManager::start() {
         });
     }
     numOfRunningThreads++;
-    futures.push_back(startTask(currThreadIndex));
+    int slot = freeSlots.back();
+    freeSlots.pop_back();
+    futures.push_back(startTask(currThreadIndex, slot));
     currThreadIndex++;
   }
+  lk.unlock();
+
+  for (auto& fut : futures) {
+    fut.wait();
+  }
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - startTime;
+  elapsedMs = elapsed.count();
 }
 
-future<void> ThreadManager::startTask(int index) {
+future<void> ThreadManager::startTask(int index, int slot) {
   // Note: Cannot capture by reference, because the "index" will be overwritten during async
-  future<void> fut = async([index, this]() {
+  future<void> fut = async([index, slot, this]() {
       if (index < 0 || index >= (int)container.size()) {
         throw "Task index out of range " + to_string(index);
       }
+      auto startTime = chrono::steady_clock::now();
       TMTask* fn = container[index];
-      (*fn)();
-      numOfRunningThreads--;
+      {
+        Tracer::get().nameThread("worker");
+        TraceSpan span("task", "worker", "index", index);
+        (*fn)();
+      }
+      chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - startTime;
 
+      {
+        lock_guard<mutex> lk(mut);
+        busyMs[slot] += elapsed.count();
+        freeSlots.push_back(slot);
+        numOfRunningThreads--;
+      }
       cv.notify_one();
     });
   return fut;
 }
+
+const vector<double>& ThreadManager::getBusyMs() {
+  return busyMs;
+}
+
+double ThreadManager::getElapsedMs() {
+  return elapsedMs;
+}
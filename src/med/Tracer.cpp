@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <unistd.h>
+#include <sys/syscall.h> //SYS_gettid
+
+#include "med/Tracer.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+static thread_local void* threadEvents = NULL; // Tracer::ThreadEvents of this thread
+static thread_local const char* threadName = "thread";
+
+Tracer& Tracer::get() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer() {
+  enabled = false;
+  count = 0;
+  epoch = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+  const char* file = getenv("MED_TRACE");
+  if (file && *file) {
+    autoSaveFile = file;
+    start();
+  }
+}
+
+Tracer::~Tracer() {
+  stop();
+  if (autoSaveFile.size()) {
+    try {
+      save(autoSaveFile);
+    } catch (MedException& ex) {
+      cerr << ex.getMessage() << endl;
+    }
+  }
+}
+
+void Tracer::start() {
+  std::lock_guard<std::mutex> lock(threadsMutex);
+  for (auto& thread : threads) {
+    std::lock_guard<std::mutex> threadLock(thread->mutex);
+    thread->events.clear();
+  }
+  count = 0;
+  enabled = true;
+}
+
+void Tracer::stop() {
+  enabled = false;
+}
+
+int64_t Tracer::now() {
+  return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count() - epoch;
+}
+
+Tracer::ThreadEvents* Tracer::getThreadEvents() {
+  if (threadEvents) {
+    return (ThreadEvents*)threadEvents;
+  }
+  auto events = make_shared<ThreadEvents>();
+  events->tid = syscall(SYS_gettid);
+  events->name = threadName;
+
+  std::lock_guard<std::mutex> lock(threadsMutex);
+  threads.push_back(events);
+  threadEvents = events.get();
+  return events.get();
+}
+
+void Tracer::record(const char* name, const char* category, int64_t start, int64_t end,
+                    const char* argName, uint64_t arg) {
+  if (!isEnabled() || count.fetch_add(1, std::memory_order_relaxed) >= TRACE_MAX_EVENTS) {
+    return;
+  }
+  ThreadEvents* thread = getThreadEvents();
+  std::lock_guard<std::mutex> lock(thread->mutex);
+  thread->events.push_back({ name, category, start, end - start, argName, arg });
+}
+
+void Tracer::nameThread(const char* name) {
+  threadName = name;
+  if (threadEvents) {
+    ((ThreadEvents*)threadEvents)->name = name;
+  }
+}
+
+size_t Tracer::size() {
+  return std::min(count.load(), TRACE_MAX_EVENTS);
+}
+
+void Tracer::save(const string& filename) {
+  FILE* file = fopen(filename.c_str(), "w");
+  if (!file) {
+    throw MedException("Failed to write trace: " + filename);
+  }
+  pid_t pid = getpid();
+  const char* separator = "";
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+  std::lock_guard<std::mutex> lock(threadsMutex);
+  for (auto& thread : threads) {
+    std::lock_guard<std::mutex> threadLock(thread->mutex);
+    if (!thread->events.size()) continue;
+
+    fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            separator, pid, thread->tid, thread->name);
+    separator = ",";
+    for (auto& event : thread->events) {
+      fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d",
+              event.name, event.category, event.start / 1000.0, event.duration / 1000.0, pid, thread->tid);
+      if (event.argName) {
+        fprintf(file, ",\"args\":{\"%s\":%lu}", event.argName, (unsigned long)event.arg);
+      }
+      fputc('}', file);
+    }
+  }
+  fprintf(file, "\n]}\n");
+  if (fclose(file) != 0) {
+    throw MedException("Failed to write trace: " + filename);
+  }
+}
+
+TraceSpan::TraceSpan(const char* name, const char* category, const char* argName, uint64_t arg) {
+  this->name = name;
+  this->category = category;
+  this->argName = argName;
+  this->arg = arg;
+  Tracer& tracer = Tracer::get();
+  start = tracer.isEnabled() ? tracer.now() : -1;
+}
+
+TraceSpan::~TraceSpan() {
+  if (start < 0) return;
+  Tracer& tracer = Tracer::get();
+  tracer.record(name, category, start, tracer.now(), argName, arg);
+}
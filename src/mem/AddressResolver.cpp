@@ -0,0 +1,242 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib> //strtoull()
+
+#include "mem/AddressResolver.hpp"
+#include "mem/StringUtil.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+// Hexadecimal, with or without "0x", the whole string must be consumed
+static bool parseHex(const string& str, Address& value) {
+  string digits = str;
+  if (digits.size() > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) {
+    digits = digits.substr(2);
+  }
+  if (digits.empty() || digits.find_first_not_of("0123456789abcdefABCDEF") != string::npos) {
+    return false;
+  }
+  errno = 0;
+  unsigned long long parsed = strtoull(digits.c_str(), NULL, 16);
+  if (errno == ERANGE) {
+    return false; // More digits than an address holds
+  }
+  value = parsed;
+  return true;
+}
+
+// "+0x10" or "-0x10"
+static Address parseOffset(const string& str, const string& expression) {
+  Address value;
+  if (str.size() < 2 || (str[0] != '+' && str[0] != '-') || !parseHex(StringUtil::trim(str.substr(1)), value)) {
+    throw MedException(string("Invalid address expression: ") + expression);
+  }
+  return str[0] == '-' ? -value : value;
+}
+
+static string offsetToString(Address offset) {
+  char buffer[32];
+  if ((long)offset < 0) {
+    sprintf(buffer, "-0x%lx", -offset);
+  }
+  else {
+    sprintf(buffer, "+0x%lx", offset);
+  }
+  return buffer;
+}
+
+bool AddressExpression::isAbsolute() const {
+  return module.empty() && offsets.empty();
+}
+
+string AddressExpression::toString() const {
+  char buffer[32];
+  string str;
+  if (module.size()) {
+    str = module + offsetToString(base);
+  }
+  else {
+    sprintf(buffer, "0x%lx", base);
+    str = buffer;
+  }
+  for (auto offset : offsets) {
+    str = "[" + str + "]" + offsetToString(offset);
+  }
+  return str;
+}
+
+AddressExpression AddressExpression::parse(const string& str) {
+  string s = StringUtil::trim(str);
+  if (s.empty()) {
+    throw MedException("Empty address expression");
+  }
+
+  if (s[0] == '[') {
+    int depth = 0;
+    size_t close = string::npos;
+    for (size_t i = 0; i < s.size(); i++) {
+      if (s[i] == '[') {
+        depth++;
+      }
+      else if (s[i] == ']' && --depth == 0) {
+        close = i;
+        break;
+      }
+    }
+    if (close == string::npos) {
+      throw MedException(string("Unbalanced bracket: ") + str);
+    }
+
+    AddressExpression expression = parse(s.substr(1, close - 1));
+    string rest = StringUtil::trim(s.substr(close + 1));
+    expression.offsets.push_back(rest.empty() ? 0 : parseOffset(rest, str));
+    return expression;
+  }
+
+  if (s.find_first_of("[]") != string::npos) {
+    throw MedException(string("Invalid address expression: ") + str);
+  }
+
+  AddressExpression expression;
+  expression.base = 0;
+  if (parseHex(s, expression.base)) {
+    return expression;
+  }
+
+  // Module name may contain '+' and '-', e.g. libstdc++.so.6, so the offset must have "0x"
+  size_t sign = s.find_last_of("+-");
+  Address offset;
+  if (sign != string::npos && sign > 0) {
+    string number = StringUtil::trim(s.substr(sign + 1));
+    if (number.compare(0, 2, "0x") == 0 && parseHex(number, offset)) {
+      expression.module = StringUtil::trim(s.substr(0, sign));
+      expression.base = s[sign] == '-' ? -offset : offset;
+      return expression;
+    }
+  }
+  expression.module = s;
+  return expression;
+}
+
+AddressResolver::AddressResolver(MemIO* memio) {
+  this->memio = memio;
+  generation = 0;
+  batchCount = 0;
+  pointerSize = 0;
+  targetPointerSize = sizeof(Address);
+  targetPid = -1;
+}
+
+void AddressResolver::setPointerSize(int pointerSize) {
+  if (pointerSize != 0 && pointerSize != 4 && pointerSize != 8) {
+    throw MedException("Pointer size must be 4 or 8");
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  this->pointerSize = pointerSize;
+}
+
+int AddressResolver::getPointerSize() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return currentPointerSize();
+}
+
+int AddressResolver::currentPointerSize() {
+  if (pointerSize) {
+    return pointerSize;
+  }
+  pid_t pid = memio->getPid();
+  if (pid != targetPid) {
+    targetPid = pid;
+    targetPointerSize = ::getPointerSize(pid);
+  }
+  return targetPointerSize;
+}
+
+Address AddressResolver::getModuleBase(const string& module) {
+  auto found = moduleBases.find(module);
+  if (found != moduleBases.end()) {
+    return found->second;
+  }
+  Address base = maps.getModuleBase(module);
+  moduleBases[module] = base; // Also the missing one, until the maps change
+  return base;
+}
+
+vector<Address> AddressResolver::resolve(const vector<AddressExpression>& expressions) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  bool hasModule = false;
+  for (auto& expression : expressions) {
+    hasModule = hasModule || expression.module.size();
+  }
+  if (hasModule) {
+    tracker.update(memio->getPid());
+    if (tracker.getGeneration() != generation) {
+      generation = tracker.getGeneration();
+      maps = tracker.getMaps();
+      moduleBases.clear();
+    }
+  }
+
+  vector<Address> addresses(expressions.size(), 0);
+  vector<size_t> pending; // Chains which have more pointers to follow
+  for (size_t i = 0; i < expressions.size(); i++) {
+    auto& expression = expressions[i];
+    Address base = 0;
+    if (expression.module.size()) {
+      base = getModuleBase(expression.module);
+      if (!base) continue;
+    }
+    addresses[i] = base + expression.base;
+    if (expression.offsets.size() && addresses[i]) {
+      pending.push_back(i);
+    }
+  }
+
+  // Same level of all the chains in one batch.
+  // A 32-bit pointer fills the low half of the zeroed Address, little endian.
+  int size = pending.size() ? currentPointerSize() : 0;
+  vector<Address> pointers;
+  MemSegments segments;
+  for (size_t level = 0; pending.size(); level++) {
+    pointers.assign(pending.size(), 0);
+    segments.clear();
+    for (size_t j = 0; j < pending.size(); j++) {
+      segments.push_back({ addresses[pending[j]], (Byte*)&pointers[j], (size_t)size, false });
+    }
+    memio->readBatch(segments);
+    batchCount++;
+
+    vector<size_t> next;
+    for (size_t j = 0; j < pending.size(); j++) {
+      size_t i = pending[j];
+      if (!segments[j].ok || !pointers[j]) {
+        addresses[i] = 0;
+        continue;
+      }
+      addresses[i] = pointers[j] + expressions[i].offsets[level];
+      if (level + 1 < expressions[i].offsets.size()) {
+        next.push_back(i);
+      }
+    }
+    pending = next;
+  }
+
+  return addresses;
+}
+
+Address AddressResolver::resolve(const AddressExpression& expression) {
+  return resolve(vector<AddressExpression>{ expression })[0];
+}
+
+unsigned long AddressResolver::getGeneration() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return generation;
+}
+
+size_t AddressResolver::getBatchCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return batchCount;
+}
@@ -0,0 +1,171 @@
+#include <cstring>
+#include <unistd.h> //close
+#include <sys/mman.h> //mmap
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "mem/DaemonClient.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+DaemonResults::DaemonResults() {
+  results = NULL;
+  count = 0;
+  mappedSize = 0;
+}
+
+DaemonResults::DaemonResults(int fd, size_t count) : DaemonResults() {
+  size_t size = max(count * sizeof(DaemonResult), (size_t)1);
+  void* mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); // The mapping keeps the memfd
+  if (mapped == MAP_FAILED) {
+    throw MedException("Failed to map the results");
+  }
+  results = (const DaemonResult*)mapped;
+  this->count = count;
+  mappedSize = size;
+}
+
+DaemonResults::DaemonResults(DaemonResults&& other) : DaemonResults() {
+  *this = std::move(other);
+}
+
+DaemonResults& DaemonResults::operator=(DaemonResults&& other) {
+  if (this != &other) {
+    release();
+    results = other.results;
+    count = other.count;
+    mappedSize = other.mappedSize;
+    other.results = NULL;
+    other.count = 0;
+    other.mappedSize = 0;
+  }
+  return *this;
+}
+
+DaemonResults::~DaemonResults() {
+  release();
+}
+
+void DaemonResults::release() {
+  if (results) {
+    munmap((void*)results, mappedSize);
+    results = NULL;
+  }
+}
+
+size_t DaemonResults::size() {
+  return count;
+}
+
+const DaemonResult& DaemonResults::operator[](size_t index) {
+  return results[index];
+}
+
+DaemonClient::DaemonClient(const string& socketPath) {
+  struct sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    throw MedException("Socket path is too long: " + socketPath);
+  }
+  strcpy(address.sun_path, socketPath.c_str());
+
+  socketFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (socketFd == -1 || connect(socketFd, (struct sockaddr*)&address, sizeof(address)) == -1) {
+    if (socketFd != -1) ::close(socketFd);
+    throw MedException("Failed to connect to med-daemon at " + socketPath);
+  }
+}
+
+DaemonClient::~DaemonClient() {
+  ::close(socketFd);
+}
+
+DaemonResponse DaemonClient::request(DaemonCommand command, pid_t pid, const string& payload, string& response, int* fd) {
+  DaemonRequest header = {};
+  memcpy(header.magic, DAEMON_MAGIC, sizeof(header.magic));
+  header.command = (uint32_t)command;
+  header.pid = pid;
+  header.size = payload.size();
+
+  DaemonResponse result;
+  int passed = -1;
+  if (!sendDaemonMessage(socketFd, &header, sizeof(header), payload) ||
+      !receiveDaemonHeader(socketFd, &result, sizeof(result), &passed) ||
+      !receiveDaemonPayload(socketFd, response, result.size)) {
+    if (passed != -1) ::close(passed);
+    throw MedException("Connection to med-daemon is closed");
+  }
+
+  if ((DaemonStatus)result.status != DaemonStatus::Ok) {
+    if (passed != -1) ::close(passed);
+    throw MedException(response);
+  }
+  if (fd) {
+    *fd = passed;
+  }
+  else if (passed != -1) {
+    ::close(passed);
+  }
+  return result;
+}
+
+DaemonResults DaemonClient::requestResults(DaemonCommand command, pid_t pid, const string& payload) {
+  string response;
+  int fd = -1;
+  DaemonResponse result = request(command, pid, payload, response, &fd);
+  if (fd == -1) {
+    throw MedException("Missing results from med-daemon");
+  }
+  return DaemonResults(fd, result.count);
+}
+
+static string addressPayload(Address addr) {
+  uint64_t address = addr;
+  return string((const char*)&address, sizeof(address));
+}
+
+void DaemonClient::open(pid_t pid) {
+  string response;
+  request(DaemonCommand::Open, pid, "", response);
+}
+
+void DaemonClient::close(pid_t pid) {
+  string response;
+  request(DaemonCommand::Close, pid, "", response);
+}
+
+DaemonResults DaemonClient::scan(pid_t pid, const string& value, const string& scanType) {
+  return requestResults(DaemonCommand::Scan, pid, scanType + '\0' + value);
+}
+
+DaemonResults DaemonClient::filter(pid_t pid, const string& value, const string& scanType) {
+  return requestResults(DaemonCommand::Filter, pid, scanType + '\0' + value);
+}
+
+DaemonResults DaemonClient::getResults(pid_t pid) {
+  return requestResults(DaemonCommand::Results, pid, "");
+}
+
+string DaemonClient::read(pid_t pid, Address addr, size_t size) {
+  DaemonRange range = { addr, size };
+  string response;
+  request(DaemonCommand::Read, pid, string((const char*)&range, sizeof(range)), response);
+  return response;
+}
+
+void DaemonClient::write(pid_t pid, Address addr, const string& bytes) {
+  string response;
+  request(DaemonCommand::Write, pid, addressPayload(addr) + bytes, response);
+}
+
+void DaemonClient::freeze(pid_t pid, Address addr, const string& value, const string& scanType) {
+  string response;
+  request(DaemonCommand::Freeze, pid, addressPayload(addr) + scanType + '\0' + value, response);
+}
+
+bool DaemonClient::unfreeze(pid_t pid, Address addr) {
+  string response;
+  return request(DaemonCommand::Unfreeze, pid, addressPayload(addr), response).count > 0;
+}
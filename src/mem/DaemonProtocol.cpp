@@ -0,0 +1,100 @@
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mem/DaemonProtocol.hpp"
+
+using namespace std;
+
+string getDaemonSocketPath() {
+  const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+  if (runtimeDir && runtimeDir[0]) {
+    return string(runtimeDir) + "/" + DAEMON_SOCKET_NAME;
+  }
+  return "/tmp/med-" + to_string(getuid()) + ".sock";
+}
+
+static bool sendAll(int socket, const char* data, size_t size) {
+  while (size) {
+    ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+    if (sent <= 0) return false;
+    data += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+static bool receiveAll(int socket, char* data, size_t size) {
+  while (size) {
+    ssize_t received = recv(socket, data, size, 0);
+    if (received <= 0) return false;
+    data += received;
+    size -= received;
+  }
+  return true;
+}
+
+bool sendDaemonMessage(int socket, const void* header, size_t headerSize, const string& payload, int fd) {
+  struct iovec iov[2] = {
+    { (void*)header, headerSize },
+    { (void*)payload.data(), payload.size() }
+  };
+  struct msghdr msg = {};
+  msg.msg_iov = iov;
+  msg.msg_iovlen = payload.size() ? 2 : 1;
+
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  if (fd != -1) {
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+  }
+
+  ssize_t sent = sendmsg(socket, &msg, MSG_NOSIGNAL);
+  if (sent < 0) return false;
+
+  // Rest of the partial send, the fd is already with the first byte
+  size_t total = headerSize + payload.size();
+  if ((size_t)sent < headerSize) {
+    return sendAll(socket, (const char*)header + sent, headerSize - sent) && sendAll(socket, payload.data(), payload.size());
+  }
+  return sendAll(socket, payload.data() + (sent - headerSize), total - sent);
+}
+
+bool receiveDaemonHeader(int socket, void* header, size_t headerSize, int* fd) {
+  struct iovec iov = { header, headerSize };
+  struct msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  char control[CMSG_SPACE(sizeof(int))] = {};
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  ssize_t received = recvmsg(socket, &msg, MSG_CMSG_CLOEXEC);
+  if (received <= 0) return false;
+
+  int passed = -1;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      memcpy(&passed, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+  if (fd) {
+    *fd = passed;
+  }
+  else if (passed != -1) {
+    close(passed); // Not expected
+  }
+
+  return receiveAll(socket, (char*)header + received, headerSize - received);
+}
+
+bool receiveDaemonPayload(int socket, string& payload, size_t size) {
+  payload.resize(size);
+  return receiveAll(socket, &payload[0], size);
+}
@@ -1,25 +1,148 @@
 #include <algorithm>
+#include <cstdio>
+#include <sstream>
 #include "mem/Maps.hpp"
 
 using namespace std;
 
+size_t MapRegion::size() const {
+  return end - start;
+}
+
+bool MapRegion::isAnonymous() const {
+  return pathname.empty();
+}
+
+string MapRegion::getModuleName() const {
+  return pathname.substr(pathname.rfind('/') + 1);
+}
+
 Maps::Maps() {}
 
 AddressPairs& Maps::getMaps() {
   return maps;
 }
 
+vector<MapRegion>& Maps::getRegions() {
+  return regions;
+}
+
 bool Maps::hasPair(const AddressPair& pair) {
-  auto it = find_if(maps.begin(), maps.end(), [&pair](AddressPair item) {
-      return std::get<0>(item) >= std::get<0>(pair) && std::get<1>(item) <= std::get<1>(pair);
-    });
-  return it != maps.end();
+  int index = findRegion(std::get<0>(pair));
+  return index >= 0 && regions[index].start == std::get<0>(pair) && regions[index].end == std::get<1>(pair);
 }
 
 void Maps::push(const AddressPair& pair) {
-  maps.push_back(pair);
+  MapRegion region = {};
+  region.start = std::get<0>(pair);
+  region.end = std::get<1>(pair);
+  region.readable = true;
+  region.writable = true;
+  push(region);
+}
+
+void Maps::push(const MapRegion& region) {
+  // Usually appended, because /proc/[pid]/maps is sorted
+  auto it = upper_bound(regions.begin(), regions.end(), region.start, [](Address addr, const MapRegion& item) {
+      return addr < item.start;
+    });
+  size_t index = it - regions.begin();
+  regions.insert(it, region);
+  maps.insert(maps.begin() + index, AddressPair(region.start, region.end));
 }
 
 size_t Maps::size() {
-  return maps.size();
+  return regions.size();
+}
+
+int Maps::findRegion(Address address) {
+  auto it = upper_bound(regions.begin(), regions.end(), address, [](Address addr, const MapRegion& item) {
+      return addr < item.start;
+    });
+  if (it == regions.begin()) {
+    return -1;
+  }
+  --it;
+  if (address >= it->end) {
+    return -1;
+  }
+  return it - regions.begin();
+}
+
+MapRegion* Maps::getRegion(Address address) {
+  int index = findRegion(address);
+  return index >= 0 ? &regions[index] : NULL;
+}
+
+Maps Maps::selectModule(const string& name) {
+  Maps selected;
+  for (auto& region : regions) {
+    if (!region.isAnonymous() && (region.pathname == name || region.getModuleName() == name)) {
+      selected.push(region);
+    }
+  }
+  return selected;
+}
+
+Address Maps::getModuleBase(const string& name) {
+  Maps module = selectModule(name);
+  if (!module.size()) {
+    return 0;
+  }
+  return module.getRegions()[0].start;
+}
+
+Maps Maps::subtract(Maps& other) {
+  Maps result;
+  auto& others = other.getRegions();
+  size_t j = 0;
+  for (auto& region : regions) {
+    Address start = region.start;
+    // Both are sorted, the other regions ending before this one are never needed again
+    while (j < others.size() && others[j].end <= start) {
+      j++;
+    }
+    for (size_t k = j; k < others.size() && others[k].start < region.end; k++) {
+      if (others[k].start > start) {
+        MapRegion part = region;
+        part.start = start;
+        part.end = others[k].start;
+        result.push(part);
+      }
+      start = std::max(start, others[k].end);
+    }
+    if (start < region.end) {
+      MapRegion part = region;
+      part.start = start;
+      result.push(part);
+    }
+  }
+  return result;
+}
+
+Maps Maps::parse(const string& content) {
+  Maps maps;
+  istringstream stream(content);
+  string line;
+  while (getline(stream, line)) {
+    MapRegion region;
+    char perms[8];
+    char device[32];
+    int nameStart = 0;
+    if (sscanf(line.c_str(), "%lx-%lx %7s %lx %31s %lu %n",
+               &region.start, &region.end, perms, &region.offset, device, &region.inode, &nameStart) < 6) {
+      continue;
+    }
+    region.readable = perms[0] == 'r';
+    region.writable = perms[1] == 'w';
+    region.executable = perms[2] == 'x';
+    region.shared = perms[3] == 's';
+    region.device = device;
+    if (nameStart > 0 && nameStart < (int)line.size()) {
+      region.pathname = line.substr(nameStart);
+      region.pathname.erase(region.pathname.find_last_not_of(" ") + 1);
+    }
+    maps.push(region);
+  }
+  return maps;
 }
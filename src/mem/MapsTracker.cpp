@@ -0,0 +1,45 @@
+#include "mem/MapsTracker.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+MapsTracker::MapsTracker() {
+  pid = -1;
+  generation = 0;
+}
+
+bool MapsTracker::update(pid_t pid, bool force) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto now = Clock::now();
+  if (pid == this->pid && !force && now < checked + chrono::milliseconds(MAPS_CHECK_INTERVAL)) {
+    return false;
+  }
+  checked = now;
+
+  string latest;
+  try {
+    latest = getMapsContent(pid);
+  } catch (MedException& ex) {
+    latest = ""; // Process is gone, nothing can be resolved
+  }
+  if (pid == this->pid && latest == content) {
+    return false;
+  }
+
+  this->pid = pid;
+  content = latest;
+  maps = Maps::parse(content);
+  generation++;
+  return true;
+}
+
+Maps MapsTracker::getMaps() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return maps;
+}
+
+unsigned long MapsTracker::getGeneration() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return generation;
+}
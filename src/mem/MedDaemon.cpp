@@ -0,0 +1,268 @@
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <fcntl.h> //fcntl
+#include <unistd.h> //close
+#include <sys/mman.h> //memfd_create
+#include <sys/socket.h>
+#include <sys/stat.h> //umask
+#include <sys/un.h>
+
+#include "mem/MedDaemon.hpp"
+#include "mem/Pem.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+MedDaemon::MedDaemon(const string& socketPath) {
+  this->socketPath = socketPath;
+  listenFd = -1;
+  running = false;
+}
+
+MedDaemon::~MedDaemon() {
+  stop();
+}
+
+void MedDaemon::start() {
+  struct sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    throw MedException("Socket path is too long: " + socketPath);
+  }
+  strcpy(address.sun_path, socketPath.c_str());
+
+  listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listenFd == -1) {
+    throw MedException("Failed to create socket");
+  }
+  unlink(socketPath.c_str()); // Left by the previous daemon
+
+  mode_t mask = umask(0077);
+  int bound = ::bind(listenFd, (struct sockaddr*)&address, sizeof(address));
+  umask(mask);
+  if (bound == -1 || listen(listenFd, 16) == -1) {
+    close(listenFd);
+    listenFd = -1;
+    throw MedException("Failed to listen on " + socketPath);
+  }
+  running = true;
+}
+
+void MedDaemon::run() {
+  while (running) {
+    int client = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+    if (client == -1) {
+      if (errno == EINTR) continue;
+      break; // Shut down by stop()
+    }
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    clients.insert(client);
+    std::thread(&MedDaemon::serve, this, client).detach();
+  }
+}
+
+void MedDaemon::stop() {
+  if (listenFd == -1) return;
+  running = false;
+  shutdown(listenFd, SHUT_RDWR);
+
+  {
+    std::unique_lock<std::mutex> lock(clientsMutex);
+    for (int fd : clients) {
+      shutdown(fd, SHUT_RDWR); // Wakes up the thread waiting for the request
+    }
+    clientsDone.wait(lock, [this] { return clients.empty(); });
+  }
+
+  close(listenFd);
+  listenFd = -1;
+  unlink(socketPath.c_str());
+
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  sessions.clear();
+}
+
+size_t MedDaemon::getSessionCount() {
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  return sessions.size();
+}
+
+void MedDaemon::serve(int client) {
+  DaemonRequest request;
+  string payload;
+  while (receiveDaemonHeader(client, &request, sizeof(request))) {
+    if (memcmp(request.magic, DAEMON_MAGIC, sizeof(request.magic)) != 0 || request.size > DAEMON_MAX_PAYLOAD) {
+      break; // Not a med client, nothing can be trusted
+    }
+    if (!receiveDaemonPayload(client, payload, request.size)) {
+      break;
+    }
+
+    string response;
+    int resultFd = -1;
+    uint64_t count = 0;
+    DaemonStatus status;
+    try {
+      status = handle(request, payload, response, resultFd, count);
+    } catch (MedException &ex) {
+      status = DaemonStatus::Error;
+      response = ex.getMessage();
+    } catch (std::exception &ex) {
+      status = DaemonStatus::Error;
+      response = ex.what();
+    }
+
+    DaemonResponse header = { (uint32_t)status, (uint32_t)response.size(), count };
+    bool sent = sendDaemonMessage(client, &header, sizeof(header), response, resultFd);
+    if (resultFd != -1) {
+      close(resultFd); // The client has its own copy
+    }
+    if (!sent) break;
+  }
+
+  std::lock_guard<std::mutex> lock(clientsMutex);
+  clients.erase(client);
+  close(client);
+  clientsDone.notify_all();
+}
+
+shared_ptr<MedDaemon::Session> MedDaemon::getSession(pid_t pid) {
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  auto found = sessions.find(pid);
+  if (found != sessions.end()) {
+    return found->second;
+  }
+  auto session = make_shared<Session>();
+  session->memed.setPid(pid);
+  sessions[pid] = session;
+  return session;
+}
+
+// "type\0value"
+static pair<string, string> splitTypeValue(const string& payload, size_t offset) {
+  size_t separator = payload.find('\0', offset);
+  if (separator == string::npos) {
+    throw MedException("Missing scan type");
+  }
+  string scanType = payload.substr(offset, separator - offset);
+  if (stringToScanType(scanType) == ScanType::Unknown) {
+    throw MedException("Unknown scan type: " + scanType); // Zero size would never finish the scan
+  }
+  return { scanType, payload.substr(separator + 1) };
+}
+
+static uint64_t payloadAddress(const string& payload) {
+  uint64_t address;
+  if (payload.size() < sizeof(address)) {
+    throw MedException("Missing address");
+  }
+  memcpy(&address, payload.data(), sizeof(address));
+  return address;
+}
+
+DaemonStatus MedDaemon::handle(const DaemonRequest& request, const string& payload, string& response, int& resultFd, uint64_t& count) {
+  auto command = (DaemonCommand)request.command;
+  if (command == DaemonCommand::Close) {
+    std::lock_guard<std::mutex> lock(sessionsMutex);
+    sessions.erase(request.pid); // Freed when the last request of it finishes
+    return DaemonStatus::Ok;
+  }
+
+  auto session = getSession(request.pid);
+  std::lock_guard<std::mutex> lock(session->mutex);
+  MemEd& memed = session->memed;
+
+  switch (command) {
+  case DaemonCommand::Open:
+    return DaemonStatus::Ok;
+
+  case DaemonCommand::Scan:
+  case DaemonCommand::Filter: {
+    auto typeValue = splitTypeValue(payload, 0);
+    if (command == DaemonCommand::Scan) {
+      memed.scan(typeValue.second, typeValue.first);
+    }
+    else {
+      memed.filter(typeValue.second, typeValue.first);
+    }
+    MemList list = memed.getScans();
+    resultFd = createResultFd(list, count);
+    return DaemonStatus::Ok;
+  }
+
+  case DaemonCommand::Results: {
+    MemList list = memed.getScans();
+    resultFd = createResultFd(list, count);
+    return DaemonStatus::Ok;
+  }
+
+  case DaemonCommand::Read: {
+    DaemonRange range;
+    if (payload.size() < sizeof(range)) {
+      throw MedException("Missing range");
+    }
+    memcpy(&range, payload.data(), sizeof(range));
+    if (range.size > DAEMON_MAX_PAYLOAD) {
+      throw MedException("Read is too large");
+    }
+    response.resize(range.size);
+    if (!memed.getMemIO()->read(range.address, (Byte*)&response[0], range.size)) {
+      throw MedException("Address read fail: " + intToHex(range.address));
+    }
+    return DaemonStatus::Ok;
+  }
+
+  case DaemonCommand::Write: {
+    Address address = payloadAddress(payload);
+    string bytes = payload.substr(sizeof(uint64_t));
+    MemSegments segments = { { address, (Byte*)&bytes[0], bytes.size(), false } };
+    if (!memed.getMemIO()->writeBatch(segments)) {
+      throw MedException("Address write fail: " + intToHex(address));
+    }
+    return DaemonStatus::Ok;
+  }
+
+  case DaemonCommand::Freeze: {
+    Address address = payloadAddress(payload);
+    auto typeValue = splitTypeValue(payload, sizeof(uint64_t));
+    memed.freezeValue(address, typeValue.second, typeValue.first);
+    return DaemonStatus::Ok;
+  }
+
+  case DaemonCommand::Unfreeze:
+    count = memed.unfreezeValue(payloadAddress(payload)) ? 1 : 0;
+    return DaemonStatus::Ok;
+
+  default:
+    throw MedException("Unknown command " + to_string(request.command));
+  }
+}
+
+int MedDaemon::createResultFd(MemList& list, uint64_t& count) {
+  count = list.size();
+  size_t size = max(count * sizeof(DaemonResult), (size_t)1); // Zero length cannot be mapped
+  int fd = memfd_create("med-results", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd == -1 || ftruncate(fd, size) == -1) {
+    if (fd != -1) close(fd);
+    throw MedException("Failed to create the result buffer");
+  }
+  void* mapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapped == MAP_FAILED) {
+    close(fd);
+    throw MedException("Failed to map the result buffer");
+  }
+
+  auto results = (DaemonResult*)mapped;
+  auto& mems = list.getList();
+  for (size_t i = 0; i < count; i++) {
+    auto pem = static_cast<Pem*>(mems[i].get());
+    results[i] = { pem->getAddress(), (uint32_t)pem->getSize(), (uint32_t)stringToScanType(pem->getScanType()) };
+  }
+  munmap(mapped, size);
+
+  // Clients can map it without trusting the daemon to leave it alone
+  fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+  return fd;
+}
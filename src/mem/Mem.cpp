@@ -15,17 +15,34 @@ Mem::Mem(Address addr, size_t size) {
 }
 
 Mem::~Mem() {
-  delete[] data;
+  release();
   size = 0;
 }
 
 void Mem::initialize(size_t size) {
-  data = new Byte[size + 1]; // Add one more space for the string case
+  // Add one more space for the string case
+  data = size <= INLINE_SIZE ? inlineData : new Byte[size + 1];
   memset(data, 0, size + 1);
   this->size = size;
   address = 0;
 }
 
+void Mem::release() {
+  if (data != inlineData) {
+    delete[] data;
+  }
+}
+
+void Mem::resize(size_t size) {
+  if (size == this->size) {
+    return;
+  }
+  Address addr = address;
+  release();
+  initialize(size);
+  address = addr;
+}
+
 void Mem::dump(bool newline) {
   for (size_t i = 0; i < size ; i++) {
     printf("%x ", data[i]);
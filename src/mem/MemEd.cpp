@@ -1,5 +1,11 @@
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <fcntl.h> //open
+#include <unistd.h> //close
+#include <sys/mman.h> //mmap
+#include <sys/stat.h> //fstat
 
 #include "mem/MemEd.hpp"
 #include "med/MedCommon.hpp"
@@ -19,12 +25,18 @@ MemEd::MemEd(pid_t pid) {
 }
 
 MemEd::~MemEd() {
+  isRunning = false;
+  lockValueThread->join();
+  delete lockValueThread;
+  scheduler->stop();
+  delete freezer;
+  delete scheduler;
+  delete pointerScanner;
+  delete resolver;
+
   delete scanner;
 
   delete store;
-
-  lockValueThread->join();
-  delete lockValueThread;
 }
 
 void MemEd::initialize() {
@@ -35,19 +47,35 @@ void MemEd::initialize() {
   store = new MemList(emptyMems);
   canResumeProcess = true;
   isProcessPaused = false;
+  scanNewRegions = false;
+
+  resolver = new AddressResolver(scanner->getMemIO());
+  scheduler = new MemScheduler(scanner->getMemIO());
+  freezer = new MemFreezer(scanner->getMemIO());
+  scheduler->subscribe(this, FREEZE_INTERVAL, FREEZE_INTERVAL); // Resolve before the freezer collects
+  scheduler->subscribe(freezer, FREEZE_INTERVAL, FREEZE_INTERVAL);
+  scheduler->start();
+
+  pointerScanner = new PointerScanner(scanner->getMemIO());
 
+  isRunning = true;
   lockValueThread = new std::thread(MemEd::callLockValues, this);
 }
 
 void MemEd::setPid(pid_t pid) {
   this->pid = pid;
   scanner->setPid(pid);
+  pointerScanner->clear();
 }
 
 pid_t MemEd::getPid() {
   return pid;
 }
 
+MemIO* MemEd::getMemIO() {
+  return scanner->getMemIO();
+}
+
 vector<MemPtr> MemEd::scan(const string& value, const string& scanType, bool fastScan, const string& lastDigit) {
   if (!ScanParser::isValid(value)) {
     throw MedException("Invalid scan string");
@@ -55,6 +83,10 @@ vector<MemPtr> MemEd::scan(const string& value, const string& scanType, bool fas
 
   ScanParser::OpType op = ScanParser::getOpType(value);
 
+  // Before scanning, so the regions mapped during the scan are also new to the next filter
+  unsigned long generation;
+  Maps maps = scanner->trackMaps(generation);
+
   vector<MemPtr> mems;
   if (op == ScanParser::OpType::SnapshotSave) {
     scanner->saveSnapshot(store->getList());
@@ -70,6 +102,7 @@ vector<MemPtr> MemEd::scan(const string& value, const string& scanType, bool fas
     mems = scanner->scan(operands, size, scanType, op, fastScan, lastDigitValue);
   }
   namedScans.setMemPtrs(mems, scanType);
+  namedScans.setMaps(maps, generation);
   return mems;
 }
 
@@ -78,22 +111,47 @@ vector<MemPtr> MemEd::filter(const string& value, const string& scanType, bool f
     throw MedException("Invalid scan string");
   }
 
+  // Compare the maps with the last scan or filter of this list
+  unsigned long generation;
+  Maps maps = scanner->trackMaps(generation);
+  unsigned long previous = namedScans.getMapsGeneration();
+  bool mapsChanged = previous && previous != generation;
+
+  vector<MemPtr> alive;
+  const vector<MemPtr>* list = &namedScans.getMemList()->getList();
+  if (mapsChanged) {
+    alive = MemScanner::dropUnmapped(*list, maps);
+    list = &alive;
+  }
+
   vector<MemPtr> mems;
   ScanParser::OpType op = ScanParser::getOpType(value);
   if (ScanParser::isSnapshotOperator(op) && !ScanParser::hasValues(value)) {
-    mems = scanner->filterUnknown(namedScans.getMemList()->getList(), scanType, op, fastScan);
+    mems = scanner->filterUnknown(*list, scanType, op, fastScan);
   } else if (scanType == SCAN_TYPE_CUSTOM) {
     ScanCommand scanCommand = ScanParser::getScanCommand(value);
-    mems = scanner->filter(namedScans.getMemList()->getList(), scanCommand);
+    mems = scanner->filter(*list, scanCommand);
   }
   else {
     Operands operands = ScanParser::valueToOperands(value, scanType, op);
     size_t size = operands.getFirstSize();
 
-    mems = scanner->filter(namedScans.getMemList()->getList(), operands, size, scanType, op);
+    mems = scanner->filter(*list, operands, size, scanType, op);
+
+    auto scope = scanner->getScope();
+    bool hasScope = scope->first && scope->second;
+    if (mapsChanged && scanNewRegions && op == ScanParser::OpType::Eq && !hasScope) {
+      Maps added = selectMaps(maps, scanner->getRegionPolicy()).subtract(namedScans.getMaps());
+      ScanStats stats = scanner->getLastStats();
+      auto found = scanner->scanRegions(added, operands, size, scanType, op, fastScan);
+      mems.insert(mems.end(), found.begin(), found.end());
+      stats.merge(scanner->getLastStats()); // Reported as one filter
+      scanner->setLastStats(stats);
+    }
   }
 
   namedScans.setMemPtrs(mems, scanType);
+  namedScans.setMaps(maps, generation);
   return mems;
 }
 
@@ -102,8 +160,13 @@ NamedScans& MemEd::getNamedScans() {
 }
 
 MemList MemEd::getScans() {
-  MemList list(namedScans.getMemList()->getList());
-  return list;
+  // Shares the published version, so the caller keeps a stable view
+  // even if a scan replaces the result in the meantime.
+  return *namedScans.getMemList();
+}
+
+ScanStats MemEd::getLastScanStats() {
+  return scanner->getLastStats();
 }
 
 vector<Process> MemEd::listProcesses() {
@@ -119,6 +182,15 @@ Process MemEd::selectProcessByIndex(int index) {
 
 void MemEd::clearScans() {
   namedScans.getMemList()->clear();
+  namedScans.setMaps(Maps(), 0);
+}
+
+void MemEd::setScanNewRegions(bool value) {
+  scanNewRegions = value;
+}
+
+bool MemEd::getScanNewRegions() {
+  return scanNewRegions;
 }
 
 MemList* MemEd::getStore() {
@@ -132,10 +204,12 @@ void MemEd::addToStoreByIndex(int index) {
   getStore()->addMemPtr(sem);
 }
 
+// The writing itself is done by the freezer, at the scheduler rate.
+// This loop only picks up the changes of the store.
 void MemEd::callLockValues(MemEd* med) {
-  while (1) {
+  while (med->isRunning) {
+    med->lockValues();
     if (med->hasLockValue()) {
-      med->lockValues();
       if (!med->getIsProcessPaused() && med->getCanResumeProcess()) {
         med->resumeProcess();
       }
@@ -145,15 +219,111 @@ void MemEd::callLockValues(MemEd* med) {
 }
 
 void MemEd::lockValues() {
+  vector<FreezeEntry> entries;
+
   storeMutex.lock();
   auto list = getStore()->getList();
   for (size_t i = 0; i < list.size(); i++) {
     auto sem = static_pointer_cast<Sem>(list[i]);
-    if (sem->isLocked()) {
-      sem->lockValue();
+    if (sem->isLocked() && sem->getAddress()) { // Unresolved expressions have no address
+      entries.push_back({ sem->getAddress(), sem->getLockedBytes() });
     }
   }
   storeMutex.unlock();
+
+  freezer->setEntries(entries);
+}
+
+void MemEd::freezeValue(Address addr, const string& value, const string& scanType) {
+  SemPtr sem = std::make_shared<Sem>(scanTypeToSize(scanType), scanner->getMemIO());
+  sem->setScanType(scanType);
+  sem->setAddress(addr);
+  sem->setDescription("Frozen");
+  sem->lock(true);
+  sem->setLockedValue(value); // After lock(), which takes the current value
+  sem->lockValue();
+  {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    getStore()->addMemPtr(sem);
+  }
+  lockValues();
+}
+
+bool MemEd::unfreezeValue(Address addr) {
+  bool found = false;
+  {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    vector<MemPtr> list = getStore()->getList();
+    for (size_t i = list.size(); i-- > 0;) {
+      auto sem = static_pointer_cast<Sem>(list[i]);
+      if (sem->getAddress() == addr && sem->isLocked()) {
+        list.erase(list.begin() + i);
+        found = true;
+      }
+    }
+    if (found) {
+      getStore()->setList(std::move(list));
+    }
+  }
+  lockValues();
+  return found;
+}
+
+void MemEd::setLockInterval(int ms) {
+  scheduler->setInterval(this, ms, ms);
+  scheduler->setInterval(freezer, ms, ms);
+}
+
+int MemEd::getLockInterval() {
+  return scheduler->getInterval(freezer);
+}
+
+void MemEd::resolveAddresses() {
+  if (!pid) return; // Without the target, MemIO reads the own memory
+
+  vector<SemPtr> sems;
+  vector<AddressExpression> expressions;
+  storeMutex.lock();
+  auto list = getStore()->getList();
+  for (size_t i = 0; i < list.size(); i++) {
+    auto sem = static_pointer_cast<Sem>(list[i]);
+    if (sem->hasAddressExpression()) {
+      sems.push_back(sem);
+      expressions.push_back(sem->getAddressExpression());
+    }
+  }
+  storeMutex.unlock();
+  if (!sems.size()) return;
+
+  auto addresses = resolver->resolve(expressions);
+  bool changed = false;
+  storeMutex.lock(); // Readers of the store take the address under the same lock
+  for (size_t i = 0; i < sems.size(); i++) {
+    if (sems[i]->getAddress() != addresses[i]) {
+      sems[i]->setAddress(addresses[i]);
+      changed = true;
+    }
+  }
+  storeMutex.unlock();
+  if (changed) {
+    lockValues(); // Freezer must follow the new addresses in this tick
+  }
+}
+
+void MemEd::collect(vector<MemRange>&) {
+  resolveAddresses();
+}
+
+bool MemEd::deliver(const MemSegments&, MemSegments&) {
+  return false;
+}
+
+size_t MemEd::getLockRevertCount(Address addr) {
+  return freezer->getRevertCount(addr);
+}
+
+MemScheduler* MemEd::getScheduler() {
+  return scheduler;
 }
 
 bool MemEd::hasLockValue() {
@@ -168,22 +338,39 @@ bool MemEd::hasLockValue() {
 }
 
 
-void MemEd::saveFile(const char* filename) {
+void MemEd::saveFile(const char* filename, bool withValues) {
+  string name = filename;
+  if (name.size() >= STORE_TABLE_EXTENSION.size() &&
+      name.compare(name.size() - STORE_TABLE_EXTENSION.size(), string::npos, STORE_TABLE_EXTENSION) == 0) {
+    saveTable(filename);
+    return;
+  }
+
   Json::Value root;
   Json::Value addresses;
   root["addresses"] = addresses;
 
-  auto list = getStore()->getList();
-  for (auto address: list) {
-    auto sem = static_pointer_cast<Sem>(address);
+  vector<MemPtr> list;
+  {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    list = getStore()->getList();
+  }
+  vector<string> values;
+  if (withValues) {
+    values = readValues(list);
+  }
+
+  for (size_t i = 0; i < list.size(); i++) {
+    auto sem = static_pointer_cast<Sem>(list[i]);
     Json::Value pairs;
     pairs["description"] = sem->getDescription();
     pairs["address"] = sem->getAddressAsString();
+    if (sem->hasAddressExpression()) {
+      pairs["expression"] = sem->getAddressExpression().toString(); // The address is only the last resolved
+    }
     pairs["type"] = sem->getScanType();
-    try {
-      pairs["value"] = sem->getValue();
-    } catch(MedException &ex) {
-      pairs["value"] = "";
+    if (withValues) {
+      pairs["value"] = values[i];
     }
     pairs["lock"] = sem->isLocked();
     root["addresses"].append(pairs);
@@ -199,8 +386,171 @@ void MemEd::saveFile(const char* filename) {
   ofs.close();
 }
 
+vector<string> MemEd::readValues(const vector<MemPtr>& list) {
+  size_t total = 0;
+  for (auto& mem : list) {
+    total += static_pointer_cast<Sem>(mem)->getPreviewSize() + 1; // Terminated, for the string
+  }
+  vector<Byte> buffer(total, 0);
+
+  MemSegments segments;
+  segments.reserve(list.size());
+  size_t offset = 0;
+  for (auto& mem : list) {
+    size_t size = static_pointer_cast<Sem>(mem)->getPreviewSize();
+    segments.push_back({ mem->getAddress(), buffer.data() + offset, size, false });
+    offset += size + 1;
+  }
+  scanner->getMemIO()->readBatch(segments);
+
+  vector<string> values;
+  values.reserve(list.size());
+  for (size_t i = 0; i < list.size(); i++) {
+    auto sem = static_pointer_cast<Sem>(list[i]);
+    if (segments[i].ok) {
+      values.push_back(Pem::bytesToString(segments[i].buffer, sem->getScanType()));
+    }
+    else if (segments[i].size > sem->getSize()) { // String preview, read the match alone
+      string value = sem->getValue();
+      values.push_back(value == "(invalid)" ? "" : value);
+    }
+    else {
+      values.push_back("");
+    }
+  }
+  return values;
+}
+
+void MemEd::saveTable(const char* filename) {
+  vector<MemPtr> list;
+  {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    list = getStore()->getList();
+  }
+
+  string text;
+  vector<StoreTableEntry> entries;
+  entries.reserve(list.size());
+  for (auto& mem : list) {
+    auto sem = static_pointer_cast<Sem>(mem);
+    StoreTableEntry entry = {};
+    entry.address = sem->getAddress();
+    entry.textOffset = text.size();
+    entry.scanType = (uint32_t)stringToScanType(sem->getScanType());
+    entry.flags = sem->isLocked() ? 1 : 0;
+
+    string description = sem->getDescription();
+    entry.descriptionLength = description.size();
+    text += description;
+    if (sem->hasAddressExpression()) {
+      string expression = sem->getAddressExpression().toString();
+      entry.expressionLength = expression.size();
+      text += expression;
+    }
+    entries.push_back(entry);
+  }
+
+  StoreTableHeader header = {};
+  memcpy(header.magic, STORE_TABLE_MAGIC, sizeof(header.magic));
+  header.version = STORE_TABLE_VERSION;
+  header.entryCount = entries.size();
+  header.entriesOffset = sizeof(header);
+  header.textOffset = header.entriesOffset + entries.size() * sizeof(StoreTableEntry);
+  header.notesOffset = text.size();
+  header.notesLength = notes.size();
+  text += notes;
+  header.textSize = text.size();
+
+  FILE* file = fopen(filename, "wb");
+  if (!file) {
+    throw MedException(string("Failed to open ") + filename);
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(entries.data(), sizeof(StoreTableEntry), entries.size(), file) == entries.size() &&
+    fwrite(text.data(), 1, text.size(), file) == text.size();
+  ok = fclose(file) == 0 && ok;
+  if (!ok) {
+    throw MedException(string("Failed to write ") + filename);
+  }
+}
+
+bool MemEd::loadTable(const char* filename) {
+  int fd = open(filename, O_RDONLY);
+  if (fd == -1) {
+    throw MedException(string("Failed to open ") + filename);
+  }
+  struct stat st;
+  char magic[sizeof(STORE_TABLE_MAGIC)];
+  if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(StoreTableHeader) ||
+      pread(fd, magic, sizeof(magic), 0) != sizeof(magic) ||
+      memcmp(magic, STORE_TABLE_MAGIC, sizeof(magic)) != 0) {
+    close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    throw MedException(string("Failed to map ") + filename);
+  }
+
+  // Offsets and lengths come from the file, so every sum is checked as a difference
+  auto header = (const StoreTableHeader*)mapped;
+  bool valid = header->version == STORE_TABLE_VERSION &&
+    header->entriesOffset % alignof(StoreTableEntry) == 0 &&
+    header->entriesOffset >= sizeof(StoreTableHeader) &&
+    header->entriesOffset <= header->textOffset &&
+    header->textOffset <= size &&
+    header->entryCount <= (header->textOffset - header->entriesOffset) / sizeof(StoreTableEntry) &&
+    header->textSize <= size - header->textOffset &&
+    header->notesOffset <= header->textSize &&
+    header->notesLength <= header->textSize - header->notesOffset;
+
+  auto entries = (const StoreTableEntry*)((Byte*)mapped + (valid ? header->entriesOffset : 0));
+  const char* text = (const char*)mapped + (valid ? header->textOffset : 0);
+  for (size_t i = 0; valid && i < header->entryCount; i++) {
+    auto& entry = entries[i];
+    valid = entry.textOffset <= header->textSize &&
+      (uint64_t)entry.descriptionLength + entry.expressionLength <= header->textSize - entry.textOffset;
+  }
+  if (!valid) {
+    munmap(mapped, size);
+    throw MedException(string("Invalid store table ") + filename);
+  }
+
+  MemIO* memio = scanner->getMemIO();
+  vector<MemPtr> list;
+  list.reserve(header->entryCount);
+  for (size_t i = 0; i < header->entryCount; i++) {
+    auto& entry = entries[i];
+    string scanType = scanTypeToString((ScanType)entry.scanType);
+    SemPtr sem = std::make_shared<Sem>(scanTypeToSize(scanType), memio);
+    sem->setAddress(entry.address);
+    if (entry.expressionLength) {
+      try {
+        sem->setAddressExpression(string(text + entry.textOffset + entry.descriptionLength, entry.expressionLength));
+      } catch(MedException &ex) {
+        cerr << "loadTable: " << ex.what() << endl;
+      }
+    }
+    sem->setScanType(scanType);
+    sem->setDescription(string(text + entry.textOffset, entry.descriptionLength));
+    sem->lock(false); // always open as false, so that do not update the value
+    list.push_back(sem);
+  }
+  string loadedNotes(text + header->notesOffset, header->notesLength);
+  munmap(mapped, size);
+
+  storeMutex.lock();
+  getStore()->setList(std::move(list));
+  storeMutex.unlock();
+  notes = loadedNotes;
+  return true;
+}
+
 void MemEd::loadLegacyJson(Json::Value& root) {
   MemIO* memio = scanner->getMemIO();
+  vector<MemPtr> list = getStore()->getList();
   for (int i = 0; i < (int)root.size(); i++) {
     string scanType = root[i]["type"].asString();
     int size = scanTypeToSize(scanType);
@@ -211,12 +561,14 @@ void MemEd::loadLegacyJson(Json::Value& root) {
     sem->setDescription(root[i]["description"].asString());
     sem->lock(false); // always open as false, so that do not update the value
 
-    getStore()->getList().push_back(sem);
+    list.push_back(sem);
   }
+  getStore()->setList(std::move(list));
 }
 
 void MemEd::loadJson(Json::Value& root) {
   MemIO* memio = scanner->getMemIO();
+  vector<MemPtr> list = getStore()->getList();
   auto& addresses = root["addresses"];
   for (int i = 0; i < (int)addresses.size(); i++) {
     string scanType = addresses[i]["type"].asString();
@@ -224,16 +576,29 @@ void MemEd::loadJson(Json::Value& root) {
 
     SemPtr sem = SemPtr(new Sem(size, memio));
     sem->setAddress(hexToInt(addresses[i]["address"].asString()));
+    if (addresses[i].isMember("expression")) {
+      try {
+        sem->setAddressExpression(addresses[i]["expression"].asString());
+      } catch(MedException &ex) {
+        cerr << "loadJson: " << ex.what() << endl;
+      }
+    }
     sem->setScanType(scanType);
     sem->setDescription(addresses[i]["description"].asString());
     sem->lock(false); // always open as false, so that do not update the value
 
-    getStore()->getList().push_back(sem);
+    list.push_back(sem);
   }
+  getStore()->setList(std::move(list));
   notes = root["notes"].asString();
 }
 
 void MemEd::openFile(const char* filename) {
+  if (loadTable(filename)) {
+    resolveAddresses();
+    return;
+  }
+
   Json::Value root;
 
   ifstream ifs;
@@ -253,6 +618,7 @@ void MemEd::openFile(const char* filename) {
     loadJson(root);
   }
   storeMutex.unlock();
+  resolveAddresses();
 }
 
 string& MemEd::getNotes() {
@@ -268,7 +634,17 @@ void MemEd::addNewAddress() {
   SemPtr sem = SemPtr(new Sem(scanTypeToSize(ScanType::Int32), memio));
   sem->setScanType(SCAN_TYPE_INT_32);
   sem->setDescription("No description");
-  store->getList().push_back(sem);
+  store->addMemPtr(sem);
+}
+
+void MemEd::setStoreAddress(int index, const string& address) {
+  {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto sem = static_pointer_cast<Sem>(getStore()->getMemPtr(index));
+    sem->setAddressExpression(address);
+  }
+  resolveAddresses();
+  lockValues();
 }
 
 MemPtr MemEd::readMemory(Address addr, size_t size) {
@@ -283,6 +659,34 @@ void MemEd::setValueByAddress(Address addr, const string& value, const string& s
   pem->setValue(value, scanType);
 }
 
+void MemEd::buildPointerIndex() {
+  pointerScanner->buildIndex();
+}
+
+vector<PointerPath> MemEd::scanPointers(Address target, const PointerScanOptions& options) {
+  if (!pointerScanner->size()) {
+    buildPointerIndex();
+  }
+  return pointerScanner->findPaths(target, options);
+}
+
+void MemEd::savePointerMap(const string& filename) {
+  if (!pointerScanner->size()) {
+    buildPointerIndex();
+  }
+  pointerScanner->save(filename);
+}
+
+void MemEd::saveSession(const string& filename) {
+  namedScans.save(filename, scanner->getSnapshot());
+}
+
+void MemEd::openSession(const string& filename) {
+  vector<MemPtr> snapshot;
+  namedScans.load(filename, scanner->getMemIO(), &snapshot);
+  scanner->setSnapshot(std::move(snapshot));
+}
+
 void MemEd::setScopeStart(Address addr) {
   scanner->setScopeStart(addr);
 }
@@ -291,8 +695,12 @@ void MemEd::setScopeEnd(Address addr) {
   scanner->setScopeEnd(addr);
 }
 
-std::mutex& MemEd::getScanListMutex() {
-  return scanner->getListMutex();
+void MemEd::setRegionPolicy(const RegionPolicy& policy) {
+  scanner->setRegionPolicy(policy);
+}
+
+RegionPolicy MemEd::getRegionPolicy() {
+  return scanner->getRegionPolicy();
 }
 
 void MemEd::resumeProcess() {
@@ -0,0 +1,105 @@
+#include <cstring>
+
+#include "mem/MemFreezer.hpp"
+#include "med/Tracer.hpp"
+
+using namespace std;
+
+MemFreezer::MemFreezer(MemIO* memio) {
+  this->memio = memio;
+}
+
+void MemFreezer::setEntries(const vector<FreezeEntry>& entries) {
+  mutex.lock();
+  std::map<Address, FreezeEntry*> previous;
+  for (size_t i = 0; i < this->entries.size(); i++) {
+    if (!fresh[i]) {
+      previous[this->entries[i].address] = &this->entries[i];
+    }
+  }
+  vector<bool> isFresh;
+  for (auto entry : entries) {
+    auto found = previous.find(entry.address);
+    isFresh.push_back(found == previous.end() ||
+                      found->second->value.getSize() != entry.value.getSize() ||
+                      memcmp(found->second->value.getBytes(), entry.value.getBytes(), entry.value.getSize()) != 0);
+  }
+  this->entries = entries;
+  fresh = isFresh;
+
+  std::map<Address, size_t> kept;
+  for (auto& entry : this->entries) {
+    kept[entry.address] = reverts[entry.address];
+  }
+  reverts = kept; // Drop the counters of unlocked entries
+  mutex.unlock();
+}
+
+size_t MemFreezer::size() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return entries.size();
+}
+
+void MemFreezer::collect(vector<MemRange>& reads) {
+  std::lock_guard<std::mutex> lock(mutex);
+  delivering = entries; // Keep the values until the writes are done
+  deliveringFresh = fresh;
+  fresh.assign(entries.size(), false);
+  for (auto& entry : delivering) {
+    reads.push_back({ entry.address, entry.value.getSize() });
+  }
+}
+
+bool MemFreezer::deliver(const MemSegments& results, MemSegments& writes) {
+  TraceSpan span("freeze", "freezer", "entries", results.size());
+  std::lock_guard<std::mutex> lock(mutex);
+  bool changed = false;
+  for (size_t i = 0; i < results.size(); i++) {
+    auto& read = results[i];
+    auto& value = delivering[i].value;
+    if (read.ok && memcmp(read.buffer, value.getBytes(), read.size) == 0) {
+      continue;
+    }
+    writes.push_back({ read.address, value.getBytes(), value.getSize(), false });
+    if (read.ok && !deliveringFresh[i]) { // First write of a new lock is not a revert
+      reverts[read.address]++;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+void MemFreezer::tick() {
+  TraceSpan span("tick", "freezer");
+  vector<MemRange> ranges;
+  collect(ranges);
+
+  size_t total = 0;
+  for (auto& range : ranges) {
+    total += range.size;
+  }
+  vector<Byte> buffer(total);
+
+  MemSegments reads;
+  Byte* pointer = buffer.data();
+  for (auto& range : ranges) {
+    reads.push_back({ range.address, pointer, range.size, false });
+    pointer += range.size;
+  }
+  memio->readBatch(reads);
+
+  MemSegments writes;
+  deliver(reads, writes);
+  if (writes.size()) {
+    memio->writeBatch(writes);
+  }
+}
+
+size_t MemFreezer::getRevertCount(Address address) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = reverts.find(address);
+  if (found == reverts.end()) {
+    return 0;
+  }
+  return found->second;
+}
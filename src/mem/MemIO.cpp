@@ -3,6 +3,9 @@
 #include <sys/ptrace.h> //ptrace()
 #include <sys/prctl.h> //prctl()
 #include <unistd.h> //open, read, lseek
+#include <fcntl.h> //open
+#include <sys/uio.h> //process_vm_readv(), process_vm_writev()
+#include <climits> //IOV_MAX
 #include <iostream>
 
 #include "med/MedException.hpp"
@@ -14,10 +17,13 @@ using namespace std;
 
 MemIO::MemIO() {
   pid = 0;
+  skipCount = 0;
+  syscallCount = 0;
 }
 
 void MemIO::setPid(pid_t pid) {
   this->pid = pid;
+  clearUnreadable();
 }
 
 pid_t MemIO::getPid() {
@@ -36,7 +42,18 @@ MemPtr MemIO::readDirect(Address addr, size_t size) {
   return mem;
 }
 
+bool MemIO::read(Address addr, Byte* buffer, size_t size) {
+  MemSegments segments = { { addr, buffer, size, false } };
+  readBatch(segments);
+  return segments[0].ok;
+}
+
 MemPtr MemIO::readProcess(Address addr, size_t size) {
+  validateUnreadable();
+  if (isUnreadable(addr, size)) {
+    throw MedException("Address read fail: " + intToHex(addr)); // Without attaching again
+  }
+
   mutex.lock();
   try {
     pidAttach(pid);
@@ -51,6 +68,7 @@ MemPtr MemIO::readProcess(Address addr, size_t size) {
   MemPtr mem = MemPtr(new Pem(size, this));
   mem->setAddress(addr);
 
+  syscallCount += 6; // Attach, wait, open, lseek, close, detach
   int memFd = getMem(pid);
   if(lseek(memFd, addr, SEEK_SET) == -1) {
     close(memFd);
@@ -58,10 +76,12 @@ MemPtr MemIO::readProcess(Address addr, size_t size) {
     mutex.unlock();
     throw MedException("Failed lseek");
   }
+  syscallCount++;
   if(::read(memFd, mem->getData(), size) == -1) {
     close(memFd);
     pidDetach(pid);
     mutex.unlock();
+    addUnreadable(addr, size);
     throw MedException("Address read fail: " + intToHex(addr));
   }
 
@@ -98,6 +118,7 @@ void MemIO::writeProcess(Address addr, MemPtr mem, size_t size) {
 
   int psize = padWordSize(writeSize);
   Byte* buf = new Byte[writeSize];
+  syscallCount += 3 + psize / sizeof(long) + (writeSize + sizeof(long) - 1) / sizeof(long); // Attach, wait, peeks, pokes, detach
 
   long word;
   for (int i = 0; i < psize; i += sizeof(long)) {
@@ -130,3 +151,250 @@ void MemIO::writeProcess(Address addr, MemPtr mem, size_t size) {
   pidDetach(pid);
   mutex.unlock();
 }
+
+size_t MemIO::readBatch(MemSegments& segments) {
+  if (!pid) {
+    return transferDirect(segments, false);
+  }
+
+  validateUnreadable();
+  bool hasUnreadable;
+  {
+    std::shared_lock<std::shared_mutex> lock(unreadableMutex);
+    hasUnreadable = unreadable.size();
+  }
+
+  size_t transferred;
+  if (!hasUnreadable) {
+    transferred = transferProcess(segments, false);
+  }
+  else {
+    // Only the segments which may be readable go to the syscalls
+    MemSegments candidates;
+    vector<size_t> indexes;
+    size_t skipped = 0;
+    for (size_t i = 0; i < segments.size(); i++) {
+      if (isUnreadable(segments[i].address, segments[i].size)) {
+        segments[i].ok = false;
+        skipped++;
+        continue;
+      }
+      candidates.push_back(segments[i]);
+      indexes.push_back(i);
+    }
+    {
+      std::unique_lock<std::shared_mutex> lock(unreadableMutex);
+      skipCount += skipped;
+    }
+    transferred = transferProcess(candidates, false);
+    for (size_t i = 0; i < candidates.size(); i++) {
+      segments[indexes[i]].ok = candidates[i].ok;
+    }
+  }
+
+  if (transferred < segments.size()) {
+    for (auto& segment : segments) {
+      if (!segment.ok) {
+        addUnreadable(segment.address, segment.size);
+      }
+    }
+  }
+  return transferred;
+}
+
+size_t MemIO::writeBatch(MemSegments& segments) {
+  if (pid) {
+    return transferProcess(segments, true);
+  }
+  return transferDirect(segments, true);
+}
+
+size_t MemIO::transferDirect(MemSegments& segments, bool isWrite) {
+  for (auto& segment : segments) {
+    if (isWrite) {
+      memcpy((Byte*)segment.address, segment.buffer, segment.size);
+    }
+    else {
+      memcpy(segment.buffer, (Byte*)segment.address, segment.size);
+    }
+    segment.ok = true;
+  }
+  return segments.size();
+}
+
+bool MemIO::isUnreadable(Address addr, size_t size) {
+  std::shared_lock<std::shared_mutex> lock(unreadableMutex);
+  if (!unreadable.size()) return false;
+
+  auto it = unreadable.upper_bound(addr);
+  if (it != unreadable.end() && it->first < addr + size) {
+    return true; // Unreadable page later in the range
+  }
+  if (it == unreadable.begin()) return false;
+  --it;
+  return addr < it->second;
+}
+
+/**
+ * Only the pages which really fail are kept. A multi-page range is probed
+ * page by page through /proc/[pid]/mem, the same as the fallback of the batch.
+ */
+void MemIO::addUnreadable(Address addr, size_t size) {
+  if (!size || isUnreadable(addr, size)) return;
+
+  Address pageSize = getpagesize();
+  Address first = addr & ~(pageSize - 1);
+  Address last = (addr + size - 1) & ~(pageSize - 1);
+
+  vector<Address> pages;
+  if (first == last) {
+    pages.push_back(first);
+  }
+  else {
+    char filename[32];
+    sprintf(filename, "/proc/%d/mem", pid);
+    int memFd = open(filename, O_RDONLY);
+    syscallCount += 2 + (memFd == -1 ? 0 : (last - first) / pageSize + 1);
+    Byte byte;
+    for (Address page = first; page <= last; page += pageSize) {
+      if (memFd == -1 || pread(memFd, &byte, 1, page) != 1) {
+        pages.push_back(page);
+      }
+    }
+    if (memFd != -1) {
+      close(memFd);
+    }
+  }
+  if (!pages.size()) return;
+
+  bool isFirst;
+  {
+    std::shared_lock<std::shared_mutex> lock(unreadableMutex);
+    isFirst = unreadable.empty();
+  }
+  if (isFirst) {
+    mapsTracker.update(pid, true); // The maps which the cache is valid for
+  }
+
+  std::unique_lock<std::shared_mutex> lock(unreadableMutex);
+  for (auto page : pages) {
+    Address start = page;
+    Address end = page + pageSize;
+    // Merge with the neighbours
+    auto it = unreadable.upper_bound(start);
+    if (it != unreadable.begin()) {
+      auto prev = std::prev(it);
+      if (prev->second >= start) {
+        start = prev->first;
+        end = std::max(end, prev->second);
+        unreadable.erase(prev);
+      }
+    }
+    it = unreadable.lower_bound(start);
+    while (it != unreadable.end() && it->first <= end) {
+      end = std::max(end, it->second);
+      it = unreadable.erase(it);
+    }
+    unreadable[start] = end;
+  }
+}
+
+void MemIO::validateUnreadable() {
+  {
+    std::shared_lock<std::shared_mutex> lock(unreadableMutex);
+    if (unreadable.empty()) return;
+  }
+  if (mapsTracker.update(pid)) {
+    clearUnreadable();
+  }
+}
+
+size_t MemIO::getUnreadableCount() {
+  std::shared_lock<std::shared_mutex> lock(unreadableMutex);
+  size_t count = 0;
+  for (auto& range : unreadable) {
+    count += (range.second - range.first) / getpagesize();
+  }
+  return count;
+}
+
+size_t MemIO::getSkipCount() {
+  std::shared_lock<std::shared_mutex> lock(unreadableMutex);
+  return skipCount;
+}
+
+size_t MemIO::getSyscallCount() {
+  return syscallCount;
+}
+
+void MemIO::clearUnreadable() {
+  std::unique_lock<std::shared_mutex> lock(unreadableMutex);
+  unreadable.clear();
+}
+
+/**
+ * process_vm_readv/writev stop at the first segment that fails.
+ * That segment is retried through /proc/[pid]/mem, which also allows writing
+ * to read-only pages, then the batch continues after it.
+ */
+size_t MemIO::transferProcess(MemSegments& segments, bool isWrite) {
+  size_t transferred = 0;
+  int memFd = -1;
+
+  vector<iovec> local;
+  vector<iovec> remote;
+  size_t i = 0;
+  while (i < segments.size()) {
+    size_t count = std::min((size_t)IOV_MAX, segments.size() - i);
+    local.resize(count);
+    remote.resize(count);
+    for (size_t j = 0; j < count; j++) {
+      local[j].iov_base = segments[i + j].buffer;
+      local[j].iov_len = segments[i + j].size;
+      remote[j].iov_base = (void*)segments[i + j].address;
+      remote[j].iov_len = segments[i + j].size;
+    }
+
+    syscallCount++;
+    ssize_t ret = isWrite ?
+      process_vm_writev(pid, local.data(), count, remote.data(), count, 0) :
+      process_vm_readv(pid, local.data(), count, remote.data(), count, 0);
+    size_t bytes = ret > 0 ? ret : 0;
+
+    size_t end = i + count;
+    while (i < end && bytes >= segments[i].size) {
+      bytes -= segments[i].size;
+      segments[i].ok = true;
+      transferred++;
+      i++;
+    }
+    if (i == end) {
+      continue;
+    }
+
+    if (memFd == -1) {
+      char filename[32];
+      sprintf(filename, "/proc/%d/mem", pid);
+      memFd = open(filename, isWrite ? O_RDWR : O_RDONLY);
+      syscallCount += 2; // With the close
+    }
+    auto& failed = segments[i];
+    ssize_t size = -1;
+    if (memFd != -1) {
+      syscallCount++;
+      size = isWrite ?
+        pwrite(memFd, failed.buffer, failed.size, failed.address) :
+        pread(memFd, failed.buffer, failed.size, failed.address);
+    }
+    failed.ok = size == (ssize_t)failed.size;
+    if (failed.ok) {
+      transferred++;
+    }
+    i++;
+  }
+
+  if (memFd != -1) {
+    close(memFd);
+  }
+  return transferred;
+}
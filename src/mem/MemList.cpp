@@ -4,87 +4,160 @@
 
 #include "mem/MemList.hpp"
 #include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
 #include "mem/Sem.hpp"
 
 using namespace std;
 
 MemList::MemList() {
-  list = vector<MemPtr>();
+  list = std::make_shared<vector<MemPtr>>();
 }
 
 MemList::MemList(vector<MemPtr> list) {
-  this->list = list;
+  this->list = std::make_shared<vector<MemPtr>>(std::move(list));
+}
+
+MemList::MemList(const MemList& other) {
+  list = std::atomic_load(&other.list);
+}
+
+MemList& MemList::operator=(const MemList& other) {
+  std::atomic_store(&list, std::atomic_load(&other.list));
+  return *this;
 }
 
 size_t MemList::size() {
-  return list.size();
+  return std::atomic_load(&list)->size();
 }
 
 string MemList::getAddressAsString(int index) {
-  return list[index]->getAddressAsString();
+  return getMemPtr(index)->getAddressAsString();
 }
 
 Address MemList::getAddress(int index) {
-  return list[index]->getAddress();
+  return getMemPtr(index)->getAddress();
 }
 
 string MemList::getValue(int index, const string& scanType) {
-  if (index >= (int)list.size()) return "";
+  auto current = std::atomic_load(&list);
+  if (index >= (int)current->size()) return "";
 
-  PemPtr pem = static_pointer_cast<Pem>(list[index]);
+  PemPtr pem = static_pointer_cast<Pem>((*current)[index]);
   return pem->getValue(scanType);
 }
 
 string MemList::getValue(int index) {
-  if (index >= (int)list.size()) return "";
+  auto current = std::atomic_load(&list);
+  if (index >= (int)current->size()) return "";
 
-  PemPtr pem = static_pointer_cast<Pem>(list[index]);
+  PemPtr pem = static_pointer_cast<Pem>((*current)[index]);
   return pem->getValue(pem->getScanType());
 }
 
+vector<string> MemList::getValues(int first, int last) {
+  first = std::max(first, 0);
+  vector<MemRange> ranges = getRanges(first, last);
+  if (!ranges.size()) return vector<string>();
+
+  size_t total = 0;
+  for (auto& range : ranges) {
+    total += range.size;
+  }
+  vector<Byte> buffer(total);
+
+  MemSegments segments;
+  Byte* pointer = buffer.data();
+  for (auto& range : ranges) {
+    segments.push_back({ range.address, pointer, range.size, false });
+    pointer += range.size;
+  }
+
+  PemPtr pem = static_pointer_cast<Pem>(getMemPtr(first));
+  pem->getMemIO()->readBatch(segments);
+  return getValues(first, segments);
+}
+
+vector<MemRange> MemList::getRanges(int first, int last) {
+  vector<MemRange> ranges;
+  auto current = std::atomic_load(&list);
+  last = std::min(last, (int)current->size() - 1);
+  for (int i = std::max(first, 0); i <= last; i++) {
+    PemPtr pem = static_pointer_cast<Pem>((*current)[i]);
+    ranges.push_back({ pem->getAddress(), pem->getPreviewSize() });
+  }
+  return ranges;
+}
+
+vector<string> MemList::getValues(int first, const MemSegments& segments) {
+  vector<string> values;
+  auto current = std::atomic_load(&list);
+  vector<Byte> terminated; // The segments are not terminated for the string
+  for (size_t i = 0; i < segments.size() && first + i < current->size(); i++) {
+    auto& segment = segments[i];
+    PemPtr pem = static_pointer_cast<Pem>((*current)[first + i]);
+    if (!segment.ok) {
+      // String preview may run into an unreadable page, read the match alone
+      values.push_back(segment.size > pem->getSize() ? pem->getValue() : "(invalid)");
+      continue;
+    }
+    terminated.assign(segment.buffer, segment.buffer + segment.size);
+    terminated.push_back(0);
+
+    try {
+      values.push_back(Pem::bytesToString(terminated.data(), pem->getScanType()));
+    } catch(MedException &ex) {
+      values.push_back("");
+    }
+  }
+  return values;
+}
+
 void MemList::dump(int index, bool newline) {
-  list[index]->dump(newline);
+  getMemPtr(index)->dump(newline);
 }
 
 string MemList::getScanType(int index) {
-  if (index >= (int)list.size()) return "";
+  auto current = std::atomic_load(&list);
+  if (index >= (int)current->size()) return "";
 
-  PemPtr pem = static_pointer_cast<Pem>(list[index]);
+  PemPtr pem = static_pointer_cast<Pem>((*current)[index]);
   return pem->getScanType();
 }
 
 void MemList::setValue(int index, const string& value, const string& scanType, bool isStored) {
   if (isStored) {
-    SemPtr sem = static_pointer_cast<Sem>(list[index]);
+    SemPtr sem = static_pointer_cast<Sem>(getMemPtr(index));
     sem->setValue(value, scanType);
     if (sem->isLocked()) {
       sem->setLockedValue(value);
     }
   } else {
-    PemPtr pem = static_pointer_cast<Pem>(list[index]);
+    PemPtr pem = static_pointer_cast<Pem>(getMemPtr(index));
     pem->setValue(value, scanType);
   }
 }
 
 void MemList::setScanType(int index, const string& scanType) {
-  PemPtr pem = static_pointer_cast<Pem>(list[index]);
+  PemPtr pem = static_pointer_cast<Pem>(getMemPtr(index));
   pem->setScanType(scanType);
 }
 
 int MemList::getLastIndex() {
-  return list.size() - 1;
+  return std::atomic_load(&list)->size() - 1;
 }
 
 void MemList::sortByAddress() {
-  MemList::sortByAddress(list);
+  auto sorted = std::make_shared<vector<MemPtr>>(*std::atomic_load(&list));
+  MemList::sortByAddress(*sorted);
+  std::atomic_store(&list, sorted);
 }
 
 void MemList::clear() {
-  list.clear();
+  std::atomic_store(&list, std::make_shared<vector<MemPtr>>());
 }
 
 void MemList::setAddress(int index, const string& address) {
-  list[index]->setAddress(hexToInt(address));
+  getMemPtr(index)->setAddress(hexToInt(address));
 }
 
 vector<MemPtr> MemList::sortByAddress(vector<MemPtr>& list) {
@@ -96,7 +169,9 @@ vector<MemPtr> MemList::sortByAddress(vector<MemPtr>& list) {
 }
 
 void MemList::sortByDescription() {
-  MemList::sortByDescription(list);
+  auto sorted = std::make_shared<vector<MemPtr>>(*std::atomic_load(&list));
+  MemList::sortByDescription(*sorted);
+  std::atomic_store(&list, sorted);
 }
 
 vector<MemPtr> MemList::sortByDescription(vector<MemPtr>& list) {
@@ -110,52 +185,57 @@ vector<MemPtr> MemList::sortByDescription(vector<MemPtr>& list) {
 }
 
 MemPtr MemList::getMemPtr(int index) {
-  return list[index];
+  return (*std::atomic_load(&list))[index];
 }
 
 void MemList::addMemPtr(MemPtr mem) {
-  list.push_back(mem);
+  auto added = std::make_shared<vector<MemPtr>>(*std::atomic_load(&list));
+  added->push_back(mem);
+  std::atomic_store(&list, added);
 }
 
 void MemList::setList(const vector<MemPtr>& list) {
-  this->list = list;
+  std::atomic_store(&this->list, std::make_shared<vector<MemPtr>>(list));
 }
-vector<MemPtr>& MemList::getList() {
-  return list;
+
+void MemList::setList(vector<MemPtr>&& list) {
+  std::atomic_store(&this->list, std::make_shared<vector<MemPtr>>(std::move(list)));
+}
+
+const vector<MemPtr>& MemList::getList() {
+  return *std::atomic_load(&list);
 }
 
 void MemList::addNextAddress(int index) {
-  auto mem = list[index];
-  SemPtr semPtr = static_pointer_cast<Sem>(mem);
+  SemPtr semPtr = static_pointer_cast<Sem>(getMemPtr(index));
   SemPtr newSem = Sem::clone(semPtr);
 
   int step = scanTypeToSize(semPtr->getScanType());
-  Address addr = semPtr->getAddress();
-  newSem->setAddress(addr + step);
+  newSem->shiftAddress(step);
   newSem->setDescription("No description");
 
-  list.push_back(newSem);
+  addMemPtr(newSem);
 }
 
 void MemList::addPrevAddress(int index) {
-  auto mem = list[index];
-  SemPtr semPtr = static_pointer_cast<Sem>(mem);
+  SemPtr semPtr = static_pointer_cast<Sem>(getMemPtr(index));
   SemPtr newSem = Sem::clone(semPtr);
 
   int step = scanTypeToSize(semPtr->getScanType());
-  Address addr = semPtr->getAddress();
-  newSem->setAddress(addr - step);
+  newSem->shiftAddress(-step);
   newSem->setDescription("No description");
 
-  list.push_back(newSem);
+  addMemPtr(newSem);
 }
 
 void MemList::shiftAddress(int index, long diff) {
-  auto mem = list[index];
+  auto mem = getMemPtr(index);
   Address addr = mem->getAddress();
   mem->setAddress(addr + diff);
 }
 
 void MemList::deleteAddress(int index) {
-  list.erase(list.begin() + index);
+  auto remaining = std::make_shared<vector<MemPtr>>(*std::atomic_load(&list));
+  remaining->erase(remaining->begin() + index);
+  std::atomic_store(&list, remaining);
 }
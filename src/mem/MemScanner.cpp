@@ -6,6 +6,7 @@
 #include "med/MemOperator.hpp"
 #include "mem/Pem.hpp"
 #include "mem/MemList.hpp"
+#include "med/Tracer.hpp"
 
 using namespace std;
 
@@ -36,6 +37,49 @@ void MemScanner::initialize() {
   threadManager->setMaxThreads(8);
   memio = new MemIO();
   scope = new AddressPair(0, 0);
+  statsSyscalls = 0;
+  statsSkips = 0;
+  statsOperation = "";
+  traceStart = -1;
+}
+
+void MemScanner::beginStats(const char* operation) {
+  lastStats = ScanStats();
+  lastStats.operation = operation;
+  statsOperation = operation;
+  statsStart = chrono::steady_clock::now();
+  traceStart = Tracer::get().isEnabled() ? Tracer::get().now() : -1;
+  statsSyscalls = memio->getSyscallCount();
+  statsSkips = memio->getSkipCount();
+}
+
+void MemScanner::endStats(bool threaded) {
+  lastStats.elapsedMs = elapsedMs(statsStart);
+  if (traceStart >= 0) {
+    Tracer::get().record(statsOperation, "scanner", traceStart, Tracer::get().now(), "matches", lastStats.matches);
+  }
+  lastStats.syscalls += memio->getSyscallCount() - statsSyscalls;
+  lastStats.readsSkipped += memio->getSkipCount() - statsSkips;
+  if (threaded) {
+    lastStats.workerBusyMs = threadManager->getBusyMs();
+    for (double busy : lastStats.workerBusyMs) {
+      lastStats.workerIdleMs.push_back(max(threadManager->getElapsedMs() - busy, 0.0));
+    }
+  }
+}
+
+ScanStats MemScanner::getLastStats() {
+  return lastStats;
+}
+
+void MemScanner::setLastStats(const ScanStats& stats) {
+  lastStats = stats;
+}
+
+static void lockTimed(std::mutex& mutex, double& waitMs) {
+  auto start = chrono::steady_clock::now();
+  mutex.lock();
+  waitMs += elapsedMs(start);
 }
 
 void MemScanner::setPid(pid_t pid) {
@@ -60,8 +104,7 @@ vector<MemPtr> MemScanner::scanInner(Operands& operands,
   vector<MemPtr> list;
   for (Address addr = base; addr + size <= base + blockSize; addr += STEP) {
     if (memCompare((void*)addr, size, operands, op)) {
-      MemPtr mem = memio->read(addr, size);
-      PemPtr pem = Pem::convertToPemPtr(mem, memio);
+      PemPtr pem = PemPtr(new Pem(addr, size, memio));
       pem->setScanType(scanType);
       pem->rememberValue((Byte*)addr, size);
 
@@ -77,8 +120,7 @@ vector<MemPtr> MemScanner::scanUnknownInner(Address base,
   int size = scanTypeToSize(scanType);
   vector<MemPtr> list;
   for (Address addr = base; addr + size <= base + blockSize; addr += STEP) {
-    MemPtr mem = memio->read(addr, size);
-    PemPtr pem = Pem::convertToPemPtr(mem, memio);
+    PemPtr pem = PemPtr(new Pem(addr, size, memio));
     pem->setScanType(scanType);
     pem->rememberValue((Byte*)addr, size);
 
@@ -152,19 +194,31 @@ vector<MemPtr> MemScanner::scanByMaps(Operands& operands,
                                       const ScanParser::OpType& op,
                                       bool fastScan,
                                       int lastDigit) {
+  Maps maps = getMaps(pid, regionPolicy);
+  return scanRegions(maps, operands, size, scanType, op, fastScan, lastDigit);
+}
+
+vector<MemPtr> MemScanner::scanRegions(Maps& maps,
+                                       Operands& operands,
+                                       int size,
+                                       const string& scanType,
+                                       const ScanParser::OpType& op,
+                                       bool fastScan,
+                                       int lastDigit) {
+  beginStats("scan");
   vector<MemPtr> list;
 
-  Maps maps = getMaps(pid);
   int memFd = getMem(pid);
   MemIO* memio = getMemIO();
 
   auto& mutex = listMutex;
+  auto& stats = lastStats;
   std::mutex fdMutex;
 
   for (size_t i = 0; i < maps.size(); i++) {
     TMTask* fn = new TMTask();
-    *fn = [memio, &mutex, &list, &maps, i, memFd, &fdMutex, &operands, size, scanType, op, fastScan, lastDigit]() {
-            scanMap(memio, mutex, list, maps, i, memFd, fdMutex, operands, size, scanType, op, fastScan, lastDigit);
+    *fn = [memio, &mutex, &list, &stats, &maps, i, memFd, &fdMutex, &operands, size, scanType, op, fastScan, lastDigit]() {
+            scanMap(memio, mutex, list, stats, maps, i, memFd, fdMutex, operands, size, scanType, op, fastScan, lastDigit);
           };
     threadManager->queueTask(fn);
   }
@@ -172,6 +226,8 @@ vector<MemPtr> MemScanner::scanByMaps(Operands& operands,
   threadManager->clear();
 
   close(memFd);
+  stats.syscalls += 2; // Open and close
+  endStats(true);
 
   if (list.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(list);
@@ -180,19 +236,21 @@ vector<MemPtr> MemScanner::scanByMaps(Operands& operands,
 }
 
 vector<MemPtr> MemScanner::scanByMaps(ScanCommand &scanCommand) {
+  beginStats("scan");
   vector<MemPtr> list;
 
-  Maps maps = getMaps(pid);
+  Maps maps = getMaps(pid, regionPolicy);
   int memFd = getMem(pid);
   MemIO* memio = getMemIO();
 
   auto& mutex = listMutex;
+  auto& stats = lastStats;
   std::mutex fdMutex;
 
   for (size_t i = 0; i < maps.size(); i++) {
     TMTask* fn = new TMTask();
-    *fn = [memio, &mutex, &list, &maps, i, memFd, &fdMutex, &scanCommand]() {
-            scanMap(memio, mutex, list, maps, i, memFd, fdMutex, scanCommand);
+    *fn = [memio, &mutex, &list, &stats, &maps, i, memFd, &fdMutex, &scanCommand]() {
+            scanMap(memio, mutex, list, stats, maps, i, memFd, fdMutex, scanCommand);
           };
     threadManager->queueTask(fn);
   }
@@ -200,6 +258,8 @@ vector<MemPtr> MemScanner::scanByMaps(ScanCommand &scanCommand) {
   threadManager->clear();
 
   close(memFd);
+  stats.syscalls += 2; // Open and close
+  endStats(true);
 
   if (list.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(list);
@@ -213,27 +273,45 @@ vector<MemPtr> MemScanner::scanByScope(Operands& operands,
                                        const ScanParser::OpType& op,
                                        bool fastScan,
                                        int lastDigit) {
+  beginStats("scan");
   vector<MemPtr> list;
+  ResultArenaPtr arena = std::make_shared<ResultArena>();
   auto start = scope->first;
   auto end = scope->second;
   int fd = getMem(pid);
-  auto& mutex = listMutex;
 
   // TODO: Refactor this, since similar to scanMap()
   for (Address j = start; j < end; j += getpagesize()) {
+    lastStats.bytesRequested += getpagesize();
+    lastStats.syscalls += 2;
     if (lseek(fd, j, SEEK_SET) == -1) {
+      lastStats.pagesUnreadable++;
+      lastStats.readErrors++;
       continue;
     }
 
     Byte* page = new Byte[getpagesize()];
+    lastStats.allocations++;
 
     if (read(fd, page, getpagesize()) == -1) {
+      delete[] page;
+      lastStats.pagesUnreadable++;
+      lastStats.readErrors++;
       continue;
     }
-    scanPage(memio, mutex, list, page, j, operands, size, scanType, op, fastScan, lastDigit);
+    lastStats.pagesRead++;
+    lastStats.bytesRead += getpagesize();
+    {
+      TraceSpan span("match", "scan");
+      scanPage(memio, list, lastStats, arena, page, j, operands, size, scanType, op, fastScan, lastDigit);
+    }
 
     delete[] page;
   }
+  close(fd);
+  lastStats.syscalls += 2; // Open and close
+  lastStats.allocations += arena->getChunkCount();
+  endStats(false);
 
   if (list.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(list);
@@ -242,27 +320,45 @@ vector<MemPtr> MemScanner::scanByScope(Operands& operands,
 }
 
 vector<MemPtr> MemScanner::scanByScope(ScanCommand &scanCommand) {
+  beginStats("scan");
   vector<MemPtr> list;
+  ResultArenaPtr arena = std::make_shared<ResultArena>();
   auto start = scope->first;
   auto end = scope->second;
   int fd = getMem(pid);
-  auto& mutex = listMutex;
 
   // TODO: Refactor this, since similar to scanMap()
   for (Address j = start; j < end; j += getpagesize()) {
+    lastStats.bytesRequested += getpagesize();
+    lastStats.syscalls += 2;
     if (lseek(fd, j, SEEK_SET) == -1) {
+      lastStats.pagesUnreadable++;
+      lastStats.readErrors++;
       continue;
     }
 
     Byte* page = new Byte[getpagesize()];
+    lastStats.allocations++;
 
     if (read(fd, page, getpagesize()) == -1) {
+      delete[] page;
+      lastStats.pagesUnreadable++;
+      lastStats.readErrors++;
       continue;
     }
-    scanPage(memio, mutex, list, page, j, scanCommand);
+    lastStats.pagesRead++;
+    lastStats.bytesRead += getpagesize();
+    {
+      TraceSpan span("match", "scan");
+      scanPage(memio, list, lastStats, arena, page, j, scanCommand);
+    }
 
     delete[] page;
   }
+  close(fd);
+  lastStats.syscalls += 2; // Open and close
+  lastStats.allocations += arena->getChunkCount();
+  endStats(false);
 
   if (list.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(list);
@@ -273,25 +369,28 @@ vector<MemPtr> MemScanner::scanByScope(ScanCommand &scanCommand) {
 
 vector<MemPtr>& MemScanner::saveSnapshot(const vector<MemPtr>& baseList) {
   snapshot.clear();
+  beginStats("snapshot");
   if (hasScope()) {
-    return saveSnapshotByScope();
+    saveSnapshotByScope();
   }
   else {
-    return saveSnapshotByList(baseList);
+    saveSnapshotByList(baseList);
   }
+  endStats(false);
+  return snapshot;
 }
 
 vector<MemPtr>& MemScanner::saveSnapshotByList(const vector<MemPtr>& baseList) {
   if (!baseList.size()) {
     throw EmptyListException("Should not scan unknown with empty list");
   }
-  Maps allMaps = getMaps(pid);
+  Maps allMaps = getMaps(pid); // The list is already selected, so no policy
   Maps maps = getInterestedMaps(allMaps, baseList);
 
   MemIO* memio = getMemIO();
 
   for (size_t i = 0; i < maps.size(); i++) {
-    saveSnapshotMap(memio, snapshot, maps, i);
+    saveSnapshotMap(memio, snapshot, lastStats, maps, i);
   }
   return snapshot;
 }
@@ -301,12 +400,20 @@ vector<MemPtr>& MemScanner::saveSnapshotByScope() {
 
   auto start = scope->first;
   auto end = scope->second;
+  TraceSpan span("snapshot scope", "snapshot", "size", end - start);
   for (Address j = start; j < end; j += size) {
-    try {
-      MemPtr mem = memio->read(j, size);
+    MemPtr mem = MemPtr(new Mem(size));
+    lastStats.allocations++;
+    lastStats.bytesRequested += size;
+    if (memio->read(j, mem->getData(), size)) {
+      mem->setAddress(j);
       snapshot.push_back(mem);
-    } catch(MedException& ex) {
-      cerr << ex.getMessage() << endl;
+      lastStats.pagesRead++;
+      lastStats.bytesRead += size;
+    }
+    else {
+      lastStats.pagesUnreadable++;
+      lastStats.readErrors++;
     }
   }
   return snapshot;
@@ -315,6 +422,7 @@ vector<MemPtr>& MemScanner::saveSnapshotByScope() {
 void MemScanner::scanMap(MemIO* memio,
                          std::mutex& mutex,
                          vector<MemPtr>& list,
+                         ScanStats& stats,
                          Maps& maps,
                          int mapIndex,
                          int fd,
@@ -327,31 +435,52 @@ void MemScanner::scanMap(MemIO* memio,
                          int lastDigit) {
   auto& pairs = maps.getMaps();
   auto& pair = pairs[mapIndex];
+  TraceSpan span("region", "scan", "size", std::get<1>(pair) - std::get<0>(pair));
+  vector<MemPtr> found; // Merged once per map, so workers do not contend on the list
+  ScanStats counted; // Merged together with the results
+  ResultArenaPtr arena = std::make_shared<ResultArena>(); // Hits of this map
   for (Address j = std::get<0>(pair); j < std::get<1>(pair); j += getpagesize()) {
     Byte* page = new Byte[getpagesize()]; //For block of memory
-
-    fdMutex.lock();
-    if (lseek(fd, j, SEEK_SET) == -1) {
-      delete[] page;
+    counted.allocations++;
+    counted.bytesRequested += getpagesize();
+
+    bool isRead;
+    {
+      TraceSpan readSpan("read", "scan");
+      lockTimed(fdMutex, counted.fdLockWaitMs);
+      counted.syscalls += 2;
+      isRead = lseek(fd, j, SEEK_SET) != -1 && read(fd, page, getpagesize()) != -1;
       fdMutex.unlock();
-      continue;
     }
-    if (read(fd, page, getpagesize()) == -1) {
+    if (!isRead) {
       delete[] page;
-      fdMutex.unlock();
+      counted.pagesUnreadable++;
+      counted.readErrors++;
       continue;
     }
-    fdMutex.unlock();
+    counted.pagesRead++;
+    counted.bytesRead += getpagesize();
 
-    scanPage(memio, mutex, list, page, j, operands, size, scanType, op, fastScan, lastDigit);
+    {
+      TraceSpan matchSpan("match", "scan");
+      scanPage(memio, found, counted, arena, page, j, operands, size, scanType, op, fastScan, lastDigit);
+    }
 
     delete[] page;
   }
+
+  counted.allocations += arena->getChunkCount();
+
+  lockTimed(mutex, counted.listLockWaitMs);
+  list.insert(list.end(), found.begin(), found.end());
+  stats.merge(counted);
+  mutex.unlock();
 }
 
 void MemScanner::scanMap(MemIO* memio,
                          std::mutex& mutex,
                          vector<MemPtr>& list,
+                         ScanStats& stats,
                          Maps& maps,
                          int mapIndex,
                          int fd,
@@ -359,42 +488,71 @@ void MemScanner::scanMap(MemIO* memio,
                          ScanCommand &scanCommand) {
   auto& pairs = maps.getMaps();
   auto& pair = pairs[mapIndex];
+  TraceSpan span("region", "scan", "size", std::get<1>(pair) - std::get<0>(pair));
+  vector<MemPtr> found; // Merged once per map, so workers do not contend on the list
+  ScanStats counted; // Merged together with the results
+  ResultArenaPtr arena = std::make_shared<ResultArena>(); // Hits of this map
   for (Address j = std::get<0>(pair); j < std::get<1>(pair); j += getpagesize()) {
     Byte* page = new Byte[getpagesize()]; //For block of memory
-
-    fdMutex.lock();
-    if (lseek(fd, j, SEEK_SET) == -1) {
-      delete[] page;
+    counted.allocations++;
+    counted.bytesRequested += getpagesize();
+
+    bool isRead;
+    {
+      TraceSpan readSpan("read", "scan");
+      lockTimed(fdMutex, counted.fdLockWaitMs);
+      counted.syscalls += 2;
+      isRead = lseek(fd, j, SEEK_SET) != -1 && read(fd, page, getpagesize()) != -1;
       fdMutex.unlock();
-      continue;
     }
-    if (read(fd, page, getpagesize()) == -1) {
+    if (!isRead) {
       delete[] page;
-      fdMutex.unlock();
+      counted.pagesUnreadable++;
+      counted.readErrors++;
       continue;
     }
-    fdMutex.unlock();
+    counted.pagesRead++;
+    counted.bytesRead += getpagesize();
 
-    scanPage(memio, mutex, list, page, j, scanCommand);
+    {
+      TraceSpan matchSpan("match", "scan");
+      scanPage(memio, found, counted, arena, page, j, scanCommand);
+    }
 
     delete[] page;
   }
+
+  counted.allocations += arena->getChunkCount();
+
+  lockTimed(mutex, counted.listLockWaitMs);
+  list.insert(list.end(), found.begin(), found.end());
+  stats.merge(counted);
+  mutex.unlock();
 }
 
 void MemScanner::saveSnapshotMap(MemIO* memio,
                                  vector<MemPtr>& snapshot,
+                                 ScanStats& stats,
                                  Maps& maps,
                                  int mapIndex) {
   int size = getpagesize();
 
   auto& pairs = maps.getMaps();
   auto& pair = pairs[mapIndex];
+  TraceSpan span("snapshot region", "snapshot", "size", std::get<1>(pair) - std::get<0>(pair));
   for (Address j = std::get<0>(pair); j < std::get<1>(pair); j += size) {
-    try {
-      MemPtr mem = memio->read(j, size);
+    MemPtr mem = MemPtr(new Mem(size));
+    stats.allocations++;
+    stats.bytesRequested += size;
+    if (memio->read(j, mem->getData(), size)) {
+      mem->setAddress(j);
       snapshot.push_back(mem);
-    } catch(MedException& ex) {
-      cerr << ex.getMessage() << endl;
+      stats.pagesRead++;
+      stats.bytesRead += size;
+    }
+    else {
+      stats.pagesUnreadable++;
+      stats.readErrors++;
     }
   }
 }
@@ -414,8 +572,9 @@ bool skipAddressByLastDigit(long address, int lastDigit) {
 }
 
 void MemScanner::scanPage(MemIO* memio,
-                          std::mutex& mutex,
                           vector<MemPtr>& list,
+                          ScanStats& stats,
+                          const ResultArenaPtr& arena,
                           Byte* page,
                           Address start,
                           Operands& operands,
@@ -436,25 +595,25 @@ void MemScanner::scanPage(MemIO* memio,
 
     try {
       if (memCompare(page + k, size, operands, op)) {
-        MemPtr mem = memio->read((Address)(start + k), size);
-
-        PemPtr pem = Pem::convertToPemPtr(mem, memio);
+        // The value is already in the page, no need to read it again
+        PemPtr pem = Pem::create((Address)(start + k), size, memio, arena);
         pem->setScanType(scanType);
         pem->rememberValue(page + k, size);
 
-        mutex.lock();
         list.push_back(pem);
-        mutex.unlock();
+        stats.matches++;
       }
     } catch(MedException& ex) {
+      stats.readErrors++;
       cerr << ex.getMessage() << endl;
     }
   }
 }
 
 void MemScanner::scanPage(MemIO* memio,
-                          std::mutex& mutex,
                           vector<MemPtr>& list,
+                          ScanStats& stats,
+                          const ResultArenaPtr& arena,
                           Byte* page,
                           Address start,
                           ScanCommand &scanCommand) {
@@ -464,17 +623,16 @@ void MemScanner::scanPage(MemIO* memio,
 
     try {
       if (scanCommand.match(page + k)) {
-        MemPtr mem = memio->read((Address)(start + k), size);
-
-        PemPtr pem = Pem::convertToPemPtr(mem, memio);
+        // The value is already in the page, no need to read it again
+        PemPtr pem = Pem::create((Address)(start + k), size, memio, arena);
         pem->setScanType(SCAN_TYPE_INT_8); // NOTE: Set to 8
         pem->rememberValue(page + k, size);
 
-        mutex.lock();
         list.push_back(pem);
-        mutex.unlock();
+        stats.matches++;
       }
     } catch(MedException& ex) {
+      stats.readErrors++;
       cerr << ex.getMessage() << endl;
     }
   }
@@ -485,19 +643,22 @@ vector<MemPtr> MemScanner::filter(const vector<MemPtr>& list,
                                   int size,
                                   const string& scanType,
                                   const ScanParser::OpType& op) {
+  beginStats("filter");
   vector<MemPtr> newList;
 
   auto& mutex = listMutex;
+  auto& stats = lastStats;
 
   for (size_t i = 0; i < list.size(); i += CHUNK_SIZE) {
     TMTask* fn = new TMTask();
-    *fn = [&mutex, &list, &newList, i, &operands, size, scanType, op]() {
-            filterByChunk(mutex, list, newList, i, operands, size, scanType, op);
+    *fn = [&mutex, &list, &newList, &stats, i, &operands, size, scanType, op]() {
+            filterByChunk(mutex, list, newList, stats, i, operands, size, scanType, op);
           };
     threadManager->queueTask(fn);
   }
   threadManager->start();
   threadManager->clear();
+  endStats(true);
 
   if (newList.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(newList);
@@ -507,19 +668,22 @@ vector<MemPtr> MemScanner::filter(const vector<MemPtr>& list,
 
 vector<MemPtr> MemScanner::filter(const vector<MemPtr> &list,
                                   ScanCommand &scanCommand) {
+  beginStats("filter");
   vector<MemPtr> newList;
 
   auto& mutex = listMutex;
+  auto& stats = lastStats;
 
   for (size_t i = 0; i < list.size(); i += CHUNK_SIZE) {
     TMTask* fn = new TMTask();
-    *fn = [&mutex, &list, &newList, i, &scanCommand]() {
-            filterByChunk(mutex, list, newList, i, scanCommand);
+    *fn = [&mutex, &list, &newList, &stats, i, &scanCommand]() {
+            filterByChunk(mutex, list, newList, stats, i, scanCommand);
           };
     threadManager->queueTask(fn);
   }
   threadManager->start();
   threadManager->clear();
+  endStats(true);
 
   if (newList.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(newList);
@@ -542,19 +706,22 @@ vector<MemPtr> MemScanner::filterUnknown(const vector<MemPtr>& list,
 vector<MemPtr> MemScanner::filterUnknownWithList(const vector<MemPtr>& list,
                                                  const string& scanType,
                                                  const ScanParser::OpType& op) {
+  beginStats("filter");
   vector<MemPtr> newList;
 
   auto& mutex = listMutex;
+  auto& stats = lastStats;
 
   for (size_t i = 0; i < list.size(); i += CHUNK_SIZE) {
     TMTask* fn = new TMTask();
-    *fn = [&mutex, &list, &newList, i, scanType, op]() {
-      filterUnknownByChunk(mutex, list, newList, i, scanType, op);
+    *fn = [&mutex, &list, &newList, &stats, i, scanType, op]() {
+      filterUnknownByChunk(mutex, list, newList, stats, i, scanType, op);
     };
     threadManager->queueTask(fn);
   }
   threadManager->start();
   threadManager->clear();
+  endStats(true);
 
   if (newList.size() <= ADDRESS_SORTABLE_SIZE) {
     return MemList::sortByAddress(newList);
@@ -565,117 +732,169 @@ vector<MemPtr> MemScanner::filterUnknownWithList(const vector<MemPtr>& list,
 void MemScanner::filterByChunk(std::mutex& mutex,
                                const vector<MemPtr>& list,
                                vector<MemPtr>& newList,
+                               ScanStats& stats,
                                int listIndex,
                                Operands& operands,
                                int size,
                                const string& scanType,
                                const ScanParser::OpType& op) {
+  TraceSpan span("chunk", "filter", "index", listIndex);
+  vector<MemPtr> found;
+  ScanStats counted;
+  ResultArenaPtr arena = std::make_shared<ResultArena>();
   for (int i = listIndex; i < listIndex + CHUNK_SIZE && i < (int)list.size(); i++) {
     PemPtr pem = static_pointer_cast<Pem>(list[i]);
-    BytePtr data;
-    try {
-      data = size > 1 ? pem->getValuePtr(size) : pem->getValuePtr();
-    } catch(MedException &ex) { // Memory not available
+    counted.bytesRequested += size;
+    BytePtr data = size > 1 ? pem->getValuePtr(size) : pem->getValuePtr();
+    if (!data) { // Memory not available
+      counted.readErrors++;
       continue;
     }
+    counted.bytesRead += size;
     if (memCompare(data.get(), size, operands, op)) {
-      pem->setScanType(scanType);
-      pem->rememberValue(data.get(), size);
+      // New object instead of mutating, because the previous result may still be read by the UI
+      PemPtr hit = Pem::create(pem->getAddress(), pem->getSize(), pem->getMemIO(), arena);
+      hit->setScanType(scanType);
+      hit->rememberValue(data.get(), size);
 
-      mutex.lock();
-      newList.push_back(pem);
-      mutex.unlock();
+      found.push_back(hit);
+      counted.matches++;
     }
   }
+
+  counted.allocations += arena->getChunkCount();
+
+  lockTimed(mutex, counted.listLockWaitMs);
+  newList.insert(newList.end(), found.begin(), found.end());
+  stats.merge(counted);
+  mutex.unlock();
 }
 
 void MemScanner::filterByChunk(std::mutex& mutex,
                                const vector<MemPtr>& list,
                                vector<MemPtr>& newList,
+                               ScanStats& stats,
                                int listIndex,
                                ScanCommand &scanCommand) {
   size_t size = scanCommand.getSize();
+  TraceSpan span("chunk", "filter", "index", listIndex);
+  vector<MemPtr> found;
+  ScanStats counted;
+  ResultArenaPtr arena = std::make_shared<ResultArena>();
   for (int i = listIndex; i < listIndex + CHUNK_SIZE && i < (int)list.size(); i++) {
     PemPtr pem = static_pointer_cast<Pem>(list[i]);
-    BytePtr data;
-    try {
-      data = size > 1 ? pem->getValuePtr(size) : pem->getValuePtr();
-    } catch(MedException &ex) { // Memory not available
+    counted.bytesRequested += size;
+    BytePtr data = size > 1 ? pem->getValuePtr(size) : pem->getValuePtr();
+    if (!data) { // Memory not available
+      counted.readErrors++;
       continue;
     }
+    counted.bytesRead += size;
     if (scanCommand.match(data.get())) {
-      pem->setScanType(SCAN_TYPE_INT_8);
-      pem->rememberValue(data.get(), size);
+      PemPtr hit = Pem::create(pem->getAddress(), pem->getSize(), pem->getMemIO(), arena);
+      hit->setScanType(SCAN_TYPE_INT_8);
+      hit->rememberValue(data.get(), size);
 
-      mutex.lock();
-      newList.push_back(pem);
-      mutex.unlock();
+      found.push_back(hit);
+      counted.matches++;
     }
   }
+
+  counted.allocations += arena->getChunkCount();
+
+  lockTimed(mutex, counted.listLockWaitMs);
+  newList.insert(newList.end(), found.begin(), found.end());
+  stats.merge(counted);
+  mutex.unlock();
 }
 
 void MemScanner::filterUnknownByChunk(std::mutex& mutex,
                                       const vector<MemPtr>& list,
                                       vector<MemPtr>& newList,
+                                      ScanStats& stats,
                                       int listIndex,
                                       const string& scanType,
                                       const ScanParser::OpType& op) {
+  TraceSpan span("chunk", "filter", "index", listIndex);
+  vector<MemPtr> found;
+  ScanStats counted;
+  ResultArenaPtr arena = std::make_shared<ResultArena>();
   for (int i = listIndex; i < listIndex + CHUNK_SIZE && i < (int)list.size(); i++) {
     int size = scanTypeToSize(scanType);
     PemPtr pem = static_pointer_cast<Pem>(list[i]);
-    BytePtr data;
-    Byte* oldValue = NULL;
-    try {
-      data = pem->getValuePtr();
-      oldValue = pem->recallValuePtr();
-    } catch(MedException &ex) {
+    counted.bytesRequested += size;
+    BytePtr data = pem->getValuePtr();
+    if (!data) {
+      counted.readErrors++;
       continue;
     }
+    counted.bytesRead += size;
+    Byte* oldValue = pem->recallValuePtr();
 
     if (memCompare(data.get(), size, oldValue, size, op)) {
-      pem->setScanType(scanType);
-      pem->rememberValue(data.get(), size);
+      PemPtr hit = Pem::create(pem->getAddress(), pem->getSize(), pem->getMemIO(), arena);
+      hit->setScanType(scanType);
+      hit->rememberValue(data.get(), size);
 
-      mutex.lock();
-      newList.push_back(pem);
-      mutex.unlock();
+      found.push_back(hit);
+      counted.matches++;
     }
   }
+
+  counted.allocations += arena->getChunkCount();
+
+  lockTimed(mutex, counted.listLockWaitMs);
+  newList.insert(newList.end(), found.begin(), found.end());
+  stats.merge(counted);
+  mutex.unlock();
 }
 
 Maps MemScanner::getInterestedMaps(Maps& maps, const vector<MemPtr>& list) {
-  Maps interested;
+  vector<bool> isInterested(maps.size(), false);
   for (size_t i = 0; i < list.size(); i++) {
-    for (size_t j = 0; j < maps.size(); j++) {
-      auto& pairs = maps.getMaps();
-      auto& pair = pairs[j];
-      auto start = std::get<0>(pair);
-      auto end = std::get<1>(pair);
-      bool inRegion = list[i]->getAddress() >= start && list[i]->getAddress() <= end;
-
-      if (inRegion) {
-        AddressPair addressPair(start, end);
-        if (!interested.hasPair(addressPair)) {
-          interested.push(addressPair);
-        }
-        break;
-      }
+    int index = maps.findRegion(list[i]->getAddress());
+    if (index >= 0) {
+      isInterested[index] = true;
+    }
+  }
+
+  Maps interested;
+  auto& regions = maps.getRegions();
+  for (size_t i = 0; i < regions.size(); i++) {
+    if (isInterested[i]) {
+      interested.push(regions[i]);
     }
   }
   return interested;
 }
 
 vector<MemPtr> MemScanner::filterSnapshot(const string& scanType, const ScanParser::OpType& op, bool fastScan) {
+  beginStats("snapshot filter");
   vector<MemPtr> list;
+  ResultArenaPtr arena = std::make_shared<ResultArena>();
   for (size_t i = 0; i < snapshot.size(); i++) {
-    auto block = memio->read(snapshot[i]->getAddress(), snapshot[i]->getSize());
-    compareBlocks(list, snapshot[i], block, scanType, op, fastScan);
+    MemPtr block = MemPtr(new Mem(snapshot[i]->getSize()));
+    lastStats.allocations++;
+    lastStats.bytesRequested += block->getSize();
+    if (!memio->read(snapshot[i]->getAddress(), block->getData(), block->getSize())) {
+      lastStats.pagesUnmapped++;
+      continue; // Unmapped after the snapshot
+    }
+    lastStats.pagesRead++;
+    lastStats.bytesRead += block->getSize();
+    block->setAddress(snapshot[i]->getAddress());
+    TraceSpan span("compare", "snapshot");
+    compareBlocks(list, lastStats, arena, snapshot[i], block, scanType, op, fastScan);
   }
   snapshot.clear();
+  lastStats.allocations += arena->getChunkCount();
+  endStats(false);
   return list;
 }
 
 void MemScanner::compareBlocks(vector<MemPtr>& list,
+                               ScanStats& stats,
+                               const ResultArenaPtr& arena,
                                MemPtr& oldBlock,
                                MemPtr& newBlock,
                                const string& scanType,
@@ -693,16 +912,24 @@ void MemScanner::compareBlocks(vector<MemPtr>& list,
     }
 
     if (memCompare(newBlockPtr + i, size, oldBlockPtr + i, size, op)) {
-      MemPtr mem = memio->read(oldAddress, size);
-      PemPtr pem = Pem::convertToPemPtr(mem, memio);
+      PemPtr pem = Pem::create(oldAddress, size, memio, arena);
       pem->setScanType(scanType);
-      pem->rememberValue(mem->getData(), size);
+      pem->rememberValue(newBlockPtr + i, size);
 
       list.push_back(pem);
+      stats.matches++;
     }
   }
 }
 
+vector<MemPtr>& MemScanner::getSnapshot() {
+  return snapshot;
+}
+
+void MemScanner::setSnapshot(vector<MemPtr>&& snapshot) {
+  this->snapshot = std::move(snapshot);
+}
+
 AddressPair* MemScanner::getScope() {
   return scope;
 }
@@ -722,3 +949,30 @@ bool MemScanner::hasScope() {
 std::mutex& MemScanner::getListMutex() {
   return listMutex;
 }
+
+void MemScanner::setRegionPolicy(const RegionPolicy& policy) {
+  regionPolicy = policy;
+}
+
+RegionPolicy MemScanner::getRegionPolicy() {
+  return regionPolicy;
+}
+
+Maps MemScanner::trackMaps(unsigned long& generation) {
+  mapsTracker.update(pid, true);
+  generation = mapsTracker.getGeneration();
+  return mapsTracker.getMaps();
+}
+
+vector<MemPtr> MemScanner::dropUnmapped(const vector<MemPtr>& list, Maps& maps) {
+  vector<MemPtr> kept;
+  kept.reserve(list.size());
+  auto& regions = maps.getRegions();
+  for (auto& mem : list) {
+    int index = maps.findRegion(mem->getAddress());
+    if (index >= 0 && regions[index].readable && mem->getAddress() + mem->getSize() <= regions[index].end) {
+      kept.push_back(mem);
+    }
+  }
+  return kept;
+}
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric> //iota
+#include <unistd.h> //read, write, close, getpagesize()
+#include <poll.h> //poll()
+#include <sys/timerfd.h> //timerfd_create()
+#include <sys/eventfd.h> //eventfd()
+
+#include "mem/MemScheduler.hpp"
+#include "med/Tracer.hpp"
+
+using namespace std;
+
+MemScheduler::MemScheduler(MemIO* memio) {
+  this->memio = memio;
+  spanCount = 0;
+  running = false;
+  timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  wakeFd = eventfd(0, EFD_CLOEXEC);
+  thread = NULL;
+}
+
+MemScheduler::~MemScheduler() {
+  stop();
+  close(timerFd);
+  close(wakeFd);
+}
+
+MemScheduler::Subscription* MemScheduler::find(MemSubscriber* subscriber) {
+  for (auto& subscription : subscriptions) {
+    if (subscription.subscriber == subscriber) {
+      return &subscription;
+    }
+  }
+  return NULL;
+}
+
+void MemScheduler::subscribe(MemSubscriber* subscriber, int minInterval, int maxInterval) {
+  mutex.lock();
+  if (!find(subscriber)) {
+    subscriptions.push_back({ subscriber, 0, 0, 0, Clock::now() });
+  }
+  mutex.unlock();
+  setInterval(subscriber, minInterval, maxInterval);
+}
+
+void MemScheduler::unsubscribe(MemSubscriber* subscriber) {
+  // Waits for the running tick, so the subscriber can be deleted afterwards
+  mutex.lock();
+  for (size_t i = 0; i < subscriptions.size(); i++) {
+    if (subscriptions[i].subscriber == subscriber) {
+      subscriptions.erase(subscriptions.begin() + i);
+      break;
+    }
+  }
+  mutex.unlock();
+}
+
+void MemScheduler::setInterval(MemSubscriber* subscriber, int minInterval, int maxInterval) {
+  minInterval = std::max(minInterval, MIN_SCHEDULE_INTERVAL);
+  maxInterval = std::max(maxInterval, minInterval);
+
+  mutex.lock();
+  Subscription* subscription = find(subscriber);
+  if (subscription) {
+    subscription->minInterval = minInterval;
+    subscription->maxInterval = maxInterval;
+    subscription->interval = minInterval;
+    subscription->due = std::min(subscription->due, Clock::now() + chrono::milliseconds(minInterval));
+  }
+  mutex.unlock();
+  notify();
+}
+
+int MemScheduler::getInterval(MemSubscriber* subscriber) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Subscription* subscription = find(subscriber);
+  return subscription ? subscription->interval : -1;
+}
+
+void MemScheduler::wake(MemSubscriber* subscriber) {
+  mutex.lock();
+  Subscription* subscription = find(subscriber);
+  if (subscription) {
+    subscription->due = Clock::now();
+  }
+  mutex.unlock();
+  notify();
+}
+
+size_t MemScheduler::getSpanCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return spanCount;
+}
+
+void MemScheduler::start() {
+  if (running) return;
+  running = true;
+  thread = new std::thread(MemScheduler::run, this);
+}
+
+void MemScheduler::stop() {
+  if (!running) return;
+  running = false;
+
+  notify();
+  thread->join();
+  delete thread;
+  thread = NULL;
+}
+
+void MemScheduler::notify() {
+  uint64_t one = 1;
+  write(wakeFd, &one, sizeof(one)); // Let the thread re-arm the timer
+}
+
+void MemScheduler::tick() {
+  std::lock_guard<std::mutex> lock(mutex);
+  TraceSpan span("tick", "scheduler");
+  auto now = Clock::now();
+
+  vector<Subscription*> due;
+  vector<size_t> starts; // First range of each due subscriber
+  ranges.clear();
+  for (auto& subscription : subscriptions) {
+    if (subscription.due > now) continue;
+    due.push_back(&subscription);
+    starts.push_back(ranges.size());
+    subscription.subscriber->collect(ranges);
+  }
+  starts.push_back(ranges.size());
+  spanCount = 0;
+  if (!due.size()) return;
+
+  // Coalesce: a range which starts in the page where the previous span ends is merged into it,
+  // so no page is read twice, and no page which is not asked is read.
+  vector<size_t> order(ranges.size());
+  iota(order.begin(), order.end(), 0);
+  sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return ranges[a].address < ranges[b].address;
+  });
+
+  Address pageSize = getpagesize();
+  vector<size_t> spanOf(ranges.size());
+  vector<size_t> spanRanges;
+  spans.clear();
+  for (auto i : order) {
+    auto& range = ranges[i];
+    if (spans.size()) {
+      auto& span = spans.back();
+      Address end = span.address + span.size;
+      Address pageEnd = (end + pageSize - 1) & ~(pageSize - 1);
+      if (range.address < pageEnd) {
+        if (range.address + range.size > end) {
+          span.size = range.address + range.size - span.address;
+        }
+        spanOf[i] = spans.size() - 1;
+        spanRanges.back()++;
+        continue;
+      }
+    }
+    spans.push_back({ range.address, NULL, range.size, false });
+    spanOf[i] = spans.size() - 1;
+    spanRanges.push_back(1);
+  }
+
+  size_t total = 0;
+  for (auto& span : spans) {
+    total += span.size;
+  }
+  buffer.resize(total);
+  Byte* pointer = buffer.data();
+  for (auto& span : spans) {
+    span.buffer = pointer;
+    pointer += span.size;
+  }
+
+  {
+    TraceSpan readSpan("read", "scheduler", "spans", spans.size());
+    memio->readBatch(spans);
+  }
+  spanCount = spans.size();
+
+  // A failed span may still contain readable ranges, read them on their own
+  vector<bool> ok(ranges.size());
+  MemSegments retries;
+  vector<size_t> retried;
+  for (size_t i = 0; i < ranges.size(); i++) {
+    auto& span = spans[spanOf[i]];
+    ok[i] = span.ok;
+    if (!span.ok && spanRanges[spanOf[i]] > 1) {
+      retries.push_back({ ranges[i].address, span.buffer + (ranges[i].address - span.address), ranges[i].size, false });
+      retried.push_back(i);
+    }
+  }
+  if (retries.size()) {
+    memio->readBatch(retries);
+    for (size_t i = 0; i < retries.size(); i++) {
+      ok[retried[i]] = retries[i].ok;
+    }
+  }
+
+  MemSegments writes;
+  MemSegments results;
+  for (size_t i = 0; i < due.size(); i++) {
+    results.clear();
+    for (size_t j = starts[i]; j < starts[i + 1]; j++) {
+      auto& span = spans[spanOf[j]];
+      results.push_back({ ranges[j].address, span.buffer + (ranges[j].address - span.address), ranges[j].size, ok[j] });
+    }
+
+    Subscription* subscription = due[i];
+    bool changed = subscription->subscriber->deliver(results, writes);
+    if (changed) {
+      subscription->interval = subscription->minInterval;
+    }
+    else {
+      subscription->interval = std::min(subscription->interval * 2, subscription->maxInterval);
+    }
+    subscription->due = now + chrono::milliseconds(subscription->interval);
+  }
+
+  if (writes.size()) {
+    memio->writeBatch(writes);
+  }
+}
+
+// One-shot timer to the earliest due subscriber, disarmed if there is none
+void MemScheduler::armTimer() {
+  itimerspec spec = {};
+  mutex.lock();
+  if (subscriptions.size()) {
+    auto earliest = subscriptions[0].due;
+    for (auto& subscription : subscriptions) {
+      earliest = std::min(earliest, subscription.due);
+    }
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(earliest.time_since_epoch()).count();
+    if (ns <= 0) {
+      ns = 1; // Zero disarms the timer
+    }
+    spec.it_value.tv_sec = ns / 1000000000L;
+    spec.it_value.tv_nsec = ns % 1000000000L;
+  }
+  mutex.unlock();
+  timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, NULL); // steady_clock is CLOCK_MONOTONIC
+}
+
+void MemScheduler::run(MemScheduler* scheduler) {
+  pollfd fds[2] = {
+    { scheduler->timerFd, POLLIN, 0 },
+    { scheduler->wakeFd, POLLIN, 0 }
+  };
+  uint64_t count;
+  Tracer::get().nameThread("scheduler");
+  while (scheduler->running) {
+    scheduler->armTimer();
+    if (poll(fds, 2, -1) == -1) {
+      continue;
+    }
+    if (fds[1].revents & POLLIN) {
+      read(scheduler->wakeFd, &count, sizeof(count));
+    }
+    if (fds[0].revents & POLLIN) {
+      read(scheduler->timerFd, &count, sizeof(count));
+      if (scheduler->running) {
+        scheduler->tick();
+      }
+    }
+  }
+}
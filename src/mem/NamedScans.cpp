@@ -1,6 +1,16 @@
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <fcntl.h> //open
+#include <unistd.h> //close
+#include <sys/mman.h> //mmap
+#include <sys/stat.h> //fstat
+
 #include "mem/NamedScans.hpp"
+#include "mem/Pem.hpp"
 #include "mem/StringUtil.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
 #include "med/MedTypes.hpp"
 
 using namespace std;
@@ -40,7 +50,7 @@ MemList* NamedScans::getMemList(string name) {
 }
 
 void NamedScans::setMemPtrs(vector<MemPtr> list, string scanType) {
-  getMemList()->setList(list);
+  getMemList()->setList(std::move(list));
   setScanType(scanType);
 }
 
@@ -52,6 +62,7 @@ bool NamedScans::remove(string name) {
   if (search != data.end()) {
     data.erase(search);
     removeScanTypes(trimmed);
+    scanMaps.erase(trimmed);
     activeName = DEFAULT;
     return true;
   }
@@ -86,3 +97,225 @@ string NamedScans::getScanType() {
 
   return result;
 }
+
+void NamedScans::setMaps(const Maps& maps, unsigned long generation) {
+  scanMaps[activeName] = { maps, generation };
+}
+
+Maps& NamedScans::getMaps() {
+  return scanMaps[activeName].first;
+}
+
+unsigned long NamedScans::getMapsGeneration() {
+  return scanMaps[activeName].second;
+}
+
+vector<string> NamedScans::getNames() {
+  vector<string> names = { DEFAULT }; // Always the first, as in the combo box
+  for (auto& entry : data) {
+    if (entry.first != DEFAULT) {
+      names.push_back(entry.first);
+    }
+  }
+  return names;
+}
+
+static void appendEntries(vector<ScanSessionEntry>& entries, string& values, const vector<MemPtr>& list, bool snapshot) {
+  for (auto& mem : list) {
+    ScanSessionEntry entry = {};
+    entry.address = mem->getAddress();
+    entry.size = mem->getSize();
+    entry.scanType = (uint32_t)ScanType::Unknown;
+
+    Byte* value = NULL;
+    if (snapshot) {
+      value = mem->getData();
+      entry.valueSize = entry.size;
+    }
+    else {
+      auto pem = static_cast<Pem*>(mem.get()); // Scan results are always Pem
+      entry.scanType = (uint32_t)stringToScanType(pem->getScanType());
+      value = pem->recallValuePtr();
+      entry.valueSize = value ? pem->recallValueSize() : 0;
+    }
+
+    entry.valueOffset = values.size();
+    if (entry.valueSize) {
+      values.append((const char*)value, entry.valueSize);
+    }
+    entries.push_back(entry);
+  }
+}
+
+void NamedScans::save(const string& filename, const vector<MemPtr>& snapshot) {
+  ScanSessionHeader header = {};
+  memcpy(header.magic, SCAN_SESSION_MAGIC, sizeof(header.magic));
+  header.version = SCAN_SESSION_VERSION;
+
+  string names;
+  string values;
+  vector<ScanSessionScan> scans;
+  vector<ScanSessionEntry> entries;
+  for (auto& entry : data) {
+    if (entry.first == activeName) {
+      header.activeIndex = scans.size();
+    }
+    auto& list = entry.second.getList();
+    auto type = scanTypes.find(entry.first);
+    ScanType scanType = stringToScanType(type != scanTypes.end() ? type->second : SCAN_TYPE_INT_32);
+    scans.push_back({ names.size(), (uint32_t)entry.first.size(), 0, entries.size(), list.size(), (uint32_t)scanType, 0 });
+    names += entry.first;
+    appendEntries(entries, values, list, false);
+  }
+  if (snapshot.size()) {
+    scans.push_back({ names.size(), 0, 1, entries.size(), snapshot.size(), (uint32_t)ScanType::Unknown, 0 });
+    appendEntries(entries, values, snapshot, true);
+  }
+  names.resize((names.size() + 7) & ~(size_t)7, '\0');
+
+  header.scanCount = scans.size();
+  header.scansOffset = sizeof(header);
+  header.namesOffset = header.scansOffset + scans.size() * sizeof(ScanSessionScan);
+  header.entriesOffset = header.namesOffset + names.size();
+  header.valuesOffset = header.entriesOffset + entries.size() * sizeof(ScanSessionEntry);
+  header.valuesSize = values.size();
+
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (!file) {
+    throw MedException("Failed to open " + filename);
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(scans.data(), sizeof(ScanSessionScan), scans.size(), file) == scans.size() &&
+    fwrite(names.data(), 1, names.size(), file) == names.size() &&
+    fwrite(entries.data(), sizeof(ScanSessionEntry), entries.size(), file) == entries.size() &&
+    fwrite(values.data(), 1, values.size(), file) == values.size();
+  ok = fclose(file) == 0 && ok;
+  if (!ok) {
+    throw MedException("Failed to write " + filename);
+  }
+}
+
+void NamedScans::load(const string& filename, MemIO* memio, vector<MemPtr>* snapshot) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw MedException("Failed to open " + filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(ScanSessionHeader)) {
+    close(fd);
+    throw MedException("Invalid scan session " + filename);
+  }
+  size_t size = st.st_size;
+  void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    throw MedException("Failed to map " + filename);
+  }
+
+  // Offsets and sizes come from the file, so every sum is checked as a difference
+  auto header = (const ScanSessionHeader*)mapped;
+  bool valid = memcmp(header->magic, SCAN_SESSION_MAGIC, sizeof(header->magic)) == 0 &&
+    header->version == SCAN_SESSION_VERSION &&
+    header->scansOffset % alignof(ScanSessionScan) == 0 &&
+    header->entriesOffset % alignof(ScanSessionEntry) == 0 &&
+    header->scansOffset >= sizeof(ScanSessionHeader) &&
+    header->scansOffset <= header->namesOffset &&
+    header->namesOffset <= header->entriesOffset &&
+    header->entriesOffset <= header->valuesOffset &&
+    header->valuesOffset <= size &&
+    header->scanCount <= (header->namesOffset - header->scansOffset) / sizeof(ScanSessionScan) &&
+    header->valuesSize <= size - header->valuesOffset;
+  if (!valid) {
+    munmap(mapped, size);
+    throw MedException("Invalid scan session " + filename);
+  }
+
+  auto scans = (const ScanSessionScan*)((Byte*)mapped + header->scansOffset);
+  auto entries = (const ScanSessionEntry*)((Byte*)mapped + header->entriesOffset);
+  const char* names = (const char*)mapped + header->namesOffset;
+  const Byte* values = (const Byte*)mapped + header->valuesOffset;
+  size_t namesSize = header->entriesOffset - header->namesOffset;
+  size_t entryCount = (header->valuesOffset - header->entriesOffset) / sizeof(ScanSessionEntry);
+  size_t pageSize = getpagesize();
+  for (size_t i = 0; valid && i < header->scanCount; i++) {
+    auto& scan = scans[i];
+    valid = scan.firstEntry <= entryCount && scan.entryCount <= entryCount - scan.firstEntry &&
+      scan.nameOffset <= namesSize && scan.nameLength <= namesSize - scan.nameOffset;
+
+    // Snapshot blocks are pages, results are at most a string match
+    size_t maxSize = (scan.flags & 1) ? pageSize : MAX_STRING_SIZE;
+    for (size_t j = 0; valid && j < scan.entryCount; j++) {
+      auto& entry = entries[scan.firstEntry + j];
+      valid = entry.size <= maxSize && entry.valueSize <= entry.size &&
+        entry.valueOffset <= header->valuesSize && entry.valueSize <= header->valuesSize - entry.valueOffset;
+    }
+  }
+  if (!valid) {
+    munmap(mapped, size);
+    throw MedException("Invalid scan session " + filename);
+  }
+
+  data.clear();
+  scanTypes.clear();
+  scanMaps.clear();
+  activeName = DEFAULT;
+  if (snapshot) {
+    snapshot->clear();
+  }
+
+  for (size_t i = 0; i < header->scanCount; i++) {
+    auto& scan = scans[i];
+    auto first = entries + scan.firstEntry;
+
+    if (scan.flags & 1) {
+      if (!snapshot) continue;
+      snapshot->reserve(snapshot->size() + scan.entryCount);
+      for (size_t j = 0; j < scan.entryCount; j++) {
+        MemPtr block = MemPtr(new Mem(first[j].size));
+        memcpy(block->getData(), values + first[j].valueOffset, min((size_t)first[j].valueSize, block->getSize()));
+        block->setAddress(first[j].address);
+        snapshot->push_back(block);
+      }
+      continue;
+    }
+
+    // Remembered values come from the file, the target memory is not read.
+    // They are copied once per scan and the entries share that buffer.
+    size_t valuesStart = scan.entryCount ? first[0].valueOffset : 0;
+    size_t valuesEnd = valuesStart;
+    for (size_t j = 0; j < scan.entryCount; j++) {
+      valuesStart = min(valuesStart, (size_t)first[j].valueOffset);
+      valuesEnd = max(valuesEnd, (size_t)(first[j].valueOffset + first[j].valueSize));
+    }
+    BytePtr buffer(new Byte[valuesEnd - valuesStart + 1]);
+    memcpy(buffer.get(), values + valuesStart, valuesEnd - valuesStart);
+
+    vector<MemPtr> list;
+    list.reserve(scan.entryCount);
+    for (size_t j = 0; j < scan.entryCount; j++) {
+      auto& entry = first[j];
+      PemPtr pem = std::make_shared<Pem>(entry.address, entry.size, memio);
+      if ((ScanType)entry.scanType != ScanType::Unknown) {
+        pem->setScanType(scanTypeToString((ScanType)entry.scanType));
+      }
+      if (entry.valueSize) {
+        BytePtr value(buffer, buffer.get() + entry.valueOffset - valuesStart);
+        pem->rememberValue(SizedBytes(value, entry.valueSize));
+      }
+      list.push_back(pem);
+    }
+
+    string name(names + scan.nameOffset, scan.nameLength);
+    data[name].setList(std::move(list));
+    scanTypes[name] = scanTypeToString((ScanType)scan.scanType);
+    if (i == header->activeIndex) {
+      activeName = name;
+    }
+  }
+  munmap(mapped, size);
+
+  if (data.find(DEFAULT) == data.end()) {
+    data[DEFAULT] = MemList();
+    scanTypes[DEFAULT] = SCAN_TYPE_INT_32;
+  }
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 #include <cstdio>
@@ -31,12 +32,16 @@ string Pem::bytesToString(Byte* buf, const string& scanType) {
 }
 
 string Pem::getValue(const string& scanType) {
-  MemPtr pem = memio->read(address, size);
-  if (!pem) {
-    return "(invalid)";
+  size_t length = getPreviewSize(scanType);
+  vector<Byte> buf(length + 1, 0); // Terminated, for the string
+  if (!memio->read(address, buf.data(), length)) {
+    // The preview may run into an unreadable page, the matched bytes may not
+    if (length == size || !memio->read(address, buf.data(), size)) {
+      return "(invalid)";
+    }
+    buf[size] = 0;
   }
-  Byte* buf = pem->getData();
-  return Pem::bytesToString(buf, scanType);
+  return Pem::bytesToString(buf.data(), scanType);
 }
 
 string Pem::getValue() {
@@ -47,14 +52,23 @@ string Pem::getValue() {
 BytePtr Pem::getValuePtr(int n) {
   int size = n > 0 ? n : this->size;
   BytePtr buf(new Byte[size]);
-  MemPtr pem = memio->read(address, size);
-  if (!pem) {
+  if (!memio->read(address, buf.get(), size)) {
     return NULL;
   }
-  memcpy(buf.get(), pem->getData(), size);
   return buf;
 }
 
+size_t Pem::getPreviewSize(const string& scanType) {
+  if (scanType == SCAN_TYPE_STRING) {
+    return max(size, (size_t)MAX_STRING_SIZE - 1);
+  }
+  return size;
+}
+
+size_t Pem::getPreviewSize() {
+  return getPreviewSize(getScanType());
+}
+
 string Pem::getScanType() {
   return scanTypeToString(scanType);
 }
@@ -62,29 +76,22 @@ string Pem::getScanType() {
 SizedBytes Pem::stringToBytes(const string& value, const string& scanType) {
   // If scanType is string, it will just copy all
   if (scanType == SCAN_TYPE_STRING) {
-    int size = MAX_STRING_SIZE;
-    Byte* buf = new Byte[size];
-    sprintf((char*)buf, "%s", value.c_str());
-    int length = strlen((char*)buf);
-
-    BytePtr data(new Byte[length]);
-    memcpy(data.get(), buf, length);
-    delete[] buf;
-
-    return SizedBytes(data, length);
+    size_t length = min(value.size(), (size_t)MAX_STRING_SIZE - 1);
+    length = strnlen(value.c_str(), length);
+    return SizedBytes((const Byte*)value.c_str(), length);
   }
   else { // Allows parse comma
     vector<string> tokens = ScanParser::getValues(value);
     int size = scanTypeToSize(stringToScanType(scanType));
-    BytePtr data(new Byte[size * tokens.size()]);
-    Byte* pointer = data.get();
+    SizedBytes data = SizedBytes::create(size * tokens.size());
+    Byte* pointer = data.getBytes();
 
     for (size_t i = 0; i < tokens.size(); i++) {
       stringToMemory(tokens[i], stringToScanType(scanType), pointer);
       pointer += size;
     }
 
-    return SizedBytes(data, size * tokens.size());
+    return data;
   }
 }
 
@@ -102,23 +109,9 @@ void Pem::setValue(const string& value, const string& scanType) {
 
 void Pem::setScanType(const string& scanType) {
   this->scanType = stringToScanType(scanType);
-  size_t newSize;
-  Byte* newData;
-  Byte* temp;
-
-  if (this->scanType == ScanType::String) {
-    newSize = MAX_STRING_SIZE;
-    newData = new Byte[newSize];
-  }
-  else {
-    newSize = scanTypeToSize(this->scanType);
-    newData = new Byte[newSize];
+  if (this->scanType != ScanType::String) { // String keeps the matched length
+    resize(scanTypeToSize(this->scanType));
   }
-
-  temp = data;
-  data = newData;
-  size = newSize;
-  delete[] temp;
 }
 
 MemIO* Pem::getMemIO() {
@@ -133,6 +126,10 @@ void Pem::rememberValue(Byte* value, size_t size) {
   rememberedValue = SizedBytes(value, size);
 }
 
+void Pem::rememberValue(const SizedBytes& value) {
+  rememberedValue = value;
+}
+
 string Pem::recallValue(const string& scanType) {
   if (rememberedValue.isEmpty()) {
     return "";
@@ -144,6 +141,14 @@ Byte* Pem::recallValuePtr() {
   return rememberedValue.getBytes();
 }
 
+size_t Pem::recallValueSize() {
+  return rememberedValue.getSize();
+}
+
 PemPtr Pem::convertToPemPtr(MemPtr mem, MemIO* memio) {
   return PemPtr(new Pem(mem->getAddress(), mem->getSize(), memio));
 }
+
+PemPtr Pem::create(Address addr, size_t size, MemIO* memio, const ResultArenaPtr& arena) {
+  return std::allocate_shared<Pem>(ArenaAllocator<Pem>(arena), addr, size, memio);
+}
@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <fcntl.h> //open
+#include <unistd.h> //close
+#include <sys/mman.h> //mmap
+#include <sys/stat.h> //fstat
+
+#include "mem/PointerScanner.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+#include "med/ThreadManager.hpp"
+
+using namespace std;
+
+string PointerPath::toString() const {
+  char buffer[64];
+  string str;
+  if (module.size()) {
+    sprintf(buffer, "+0x%lx", moduleOffset);
+    str = module.substr(module.rfind('/') + 1) + buffer;
+  }
+  else {
+    sprintf(buffer, "0x%lx", base);
+    str = buffer;
+  }
+  for (auto offset : offsets) {
+    sprintf(buffer, "]+0x%lx", offset);
+    str = "[" + str + buffer;
+  }
+  return str;
+}
+
+PointerScanner::PointerScanner(MemIO* memio) {
+  this->memio = memio;
+  entries = NULL;
+  entryCount = 0;
+  pointerSize = sizeof(Address);
+  mapped = NULL;
+  mappedSize = 0;
+  found = 0;
+}
+
+PointerScanner::~PointerScanner() {
+  unmap();
+}
+
+const PointerEntry* PointerScanner::getEntries() {
+  return entries;
+}
+
+int PointerScanner::getPointerSize() {
+  return pointerSize;
+}
+
+void PointerScanner::unmap() {
+  if (mapped) {
+    munmap(mapped, mappedSize);
+    mapped = NULL;
+    mappedSize = 0;
+  }
+}
+
+void PointerScanner::clear() {
+  unmap();
+  index.clear();
+  regions.clear();
+  entries = NULL;
+  entryCount = 0;
+}
+
+vector<PointerRegion>& PointerScanner::getRegions() {
+  return regions;
+}
+
+size_t PointerScanner::size() {
+  return entryCount;
+}
+
+vector<PointerRegion> PointerScanner::loadRegions(pid_t pid) {
+  vector<PointerRegion> regions;
+  Maps maps = getAllMaps(pid);
+  for (auto& region : maps.getRegions()) {
+    if (!region.readable || !region.size()) {
+      continue;
+    }
+    if (region.pathname == "[vvar]" || region.pathname == "[vsyscall]") { // Not readable by process_vm_readv
+      continue;
+    }
+    bool isStatic = !region.isAnonymous() && region.pathname[0] == '/';
+    regions.push_back({ region.start, region.end, region.writable, isStatic, region.pathname });
+  }
+  return regions;
+}
+
+int PointerScanner::findRegion(Address address) {
+  auto it = upper_bound(regions.begin(), regions.end(), address, [](Address addr, const PointerRegion& region) {
+      return addr < region.start;
+    });
+  if (it == regions.begin()) {
+    return -1;
+  }
+  --it;
+  if (address >= it->end) {
+    return -1;
+  }
+  return it - regions.begin();
+}
+
+void PointerScanner::buildIndex(int pointerSize) {
+  buildIndex(loadRegions(memio->getPid()), pointerSize);
+}
+
+void PointerScanner::buildIndex(const vector<PointerRegion>& regions, int pointerSize) {
+  if (pointerSize != 4 && pointerSize != 8) {
+    throw MedException("Pointer size must be 4 or 8");
+  }
+  clear();
+  this->pointerSize = pointerSize;
+  this->regions = regions;
+  sort(this->regions.begin(), this->regions.end(), [](const PointerRegion& a, const PointerRegion& b) {
+      return a.start < b.start;
+    });
+
+  std::mutex mutex;
+  ThreadManager threadManager(std::max(std::thread::hardware_concurrency(), 1u));
+  for (auto& region : this->regions) {
+    if (!region.writable) continue;
+    for (Address start = region.start; start < region.end; start += POINTER_CHUNK_SIZE) {
+      size_t size = std::min((Address)POINTER_CHUNK_SIZE, region.end - start);
+      TMTask* fn = new TMTask();
+      *fn = [this, start, size, pointerSize, &mutex]() {
+              indexChunk(start, size, pointerSize, mutex);
+            };
+      threadManager.queueTask(fn);
+    }
+  }
+  threadManager.start();
+  threadManager.clear();
+
+  sort(index.begin(), index.end(), [](const PointerEntry& a, const PointerEntry& b) {
+      return a.target < b.target || (a.target == b.target && a.source < b.source);
+    });
+  entries = index.data();
+  entryCount = index.size();
+}
+
+void PointerScanner::indexChunk(Address start, size_t size, int pointerSize, std::mutex& mutex) {
+  vector<Byte> buffer(size);
+  MemSegments segments = { { start, buffer.data(), size, false } };
+  if (!memio->readBatch(segments)) {
+    return;
+  }
+
+  vector<PointerEntry> entries; // Merged once per chunk
+  Address aligned = (start + pointerSize - 1) & ~(Address)(pointerSize - 1);
+  for (Address address = aligned; address + pointerSize <= start + size; address += pointerSize) {
+    Address value = 0;
+    memcpy(&value, buffer.data() + (address - start), pointerSize);
+    if (findRegion(value) >= 0) {
+      entries.push_back({ value, address });
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  index.insert(index.end(), entries.begin(), entries.end());
+}
+
+vector<PointerPath> PointerScanner::findPaths(Address target, const PointerScanOptions& options) {
+  return findPaths(target, options, NULL);
+}
+
+vector<PointerPath> PointerScanner::findPaths(Address target,
+                                              const vector<PointerPath>& candidates,
+                                              const PointerScanOptions& options) {
+  PathFilter filter;
+  for (auto& path : candidates) {
+    vector<Address> reversed(path.offsets.rbegin(), path.offsets.rend());
+    for (size_t i = 1; i <= reversed.size(); i++) {
+      filter.prefixes.insert(vector<Address>(reversed.begin(), reversed.begin() + i));
+    }
+    filter.keys.insert(path.toString());
+  }
+  return findPaths(target, options, &filter);
+}
+
+vector<PointerPath> PointerScanner::findPaths(Address target, const PointerScanOptions& options, const PathFilter* filter) {
+  vector<PointerPath> results;
+  std::mutex mutex;
+  found = 0;
+  if (options.depth <= 0 || options.maxResults == 0) {
+    return results;
+  }
+
+  // First level is split across the threads, each searches the deeper levels on its own
+  Address low = target > options.maxOffset ? target - options.maxOffset : 0;
+  const PointerEntry* end = entries + entryCount;
+  auto first = lower_bound(entries, end, low, [](const PointerEntry& entry, Address addr) {
+      return entry.target < addr;
+    });
+  auto last = upper_bound(first, end, target, [](Address addr, const PointerEntry& entry) {
+      return addr < entry.target;
+    });
+
+  int threads = options.threads > 0 ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+  ThreadManager threadManager(threads);
+  size_t total = last - first;
+  size_t chunk = std::max(total / (threads * 4), (size_t)1);
+  for (size_t i = 0; i < total; i += chunk) {
+    auto from = first + i;
+    auto to = first + std::min(i + chunk, total);
+    TMTask* fn = new TMTask();
+    *fn = [this, from, to, target, &options, filter, &results, &mutex]() {
+            vector<Address> offsets;
+            for (auto it = from; it != to; ++it) {
+              offsets = { target - it->target };
+              if (filter && !filter->prefixes.count(offsets)) {
+                continue;
+              }
+              search(it->source, offsets, options.depth - 1, options, filter, results, mutex);
+            }
+          };
+    threadManager.queueTask(fn);
+  }
+  threadManager.start();
+  threadManager.clear();
+
+  sort(results.begin(), results.end(), [](const PointerPath& a, const PointerPath& b) {
+      return a.offsets.size() < b.offsets.size() ||
+        (a.offsets.size() == b.offsets.size() && a.base < b.base);
+    });
+  return results;
+}
+
+// "offsets" is from the target backward, the last one is the nearest to "address"
+void PointerScanner::search(Address address,
+                            vector<Address>& offsets,
+                            int depthLeft,
+                            const PointerScanOptions& options,
+                            const PathFilter* filter,
+                            vector<PointerPath>& results,
+                            std::mutex& mutex) {
+  if (found >= options.maxResults) {
+    return;
+  }
+
+  int region = findRegion(address);
+  if (region >= 0 && regions[region].isStatic) {
+    addPath(address, offsets, options.maxResults, filter, results, mutex);
+  }
+  if (depthLeft <= 0) {
+    return;
+  }
+
+  Address low = address > options.maxOffset ? address - options.maxOffset : 0;
+  const PointerEntry* end = entries + entryCount;
+  auto it = lower_bound(entries, end, low, [](const PointerEntry& entry, Address addr) {
+      return entry.target < addr;
+    });
+  for (; it != end && it->target <= address; ++it) {
+    if (found >= options.maxResults) {
+      return;
+    }
+    if (it->source == address) { // Points to itself
+      continue;
+    }
+    offsets.push_back(address - it->target);
+    if (!filter || filter->prefixes.count(offsets)) {
+      search(it->source, offsets, depthLeft - 1, options, filter, results, mutex);
+    }
+    offsets.pop_back();
+  }
+}
+
+void PointerScanner::addPath(Address base,
+                             const vector<Address>& offsets,
+                             size_t maxResults,
+                             const PathFilter* filter,
+                             vector<PointerPath>& results,
+                             std::mutex& mutex) {
+  PointerPath path;
+  path.base = base;
+  path.offsets.assign(offsets.rbegin(), offsets.rend());
+
+  // Module starts from its first mapping
+  int region = findRegion(base);
+  path.module = regions[region].name;
+  while (region > 0 && regions[region - 1].name == path.module) {
+    region--;
+  }
+  path.moduleOffset = base - regions[region].start;
+
+  if (filter && !filter->keys.count(path.toString())) {
+    return;
+  }
+  if (found++ >= maxResults) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  results.push_back(path);
+}
+
+void PointerScanner::save(const string& filename) {
+  PointerMapHeader header = {};
+  memcpy(header.magic, POINTER_MAP_MAGIC, sizeof(header.magic));
+  header.version = POINTER_MAP_VERSION;
+  header.pointerSize = pointerSize;
+  header.regionCount = regions.size();
+  header.entryCount = entryCount;
+
+  string names;
+  vector<PointerMapRegion> mapRegions;
+  for (auto& region : regions) {
+    uint32_t flags = (region.writable ? 1 : 0) | (region.isStatic ? 2 : 0);
+    mapRegions.push_back({ region.start, region.end, flags, (uint32_t)region.name.size(), names.size() });
+    names += region.name;
+  }
+  names.resize((names.size() + 7) & ~(size_t)7, '\0');
+
+  header.regionsOffset = sizeof(header);
+  header.namesOffset = header.regionsOffset + mapRegions.size() * sizeof(PointerMapRegion);
+  header.entriesOffset = header.namesOffset + names.size();
+
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (!file) {
+    throw MedException("Failed to open " + filename);
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(mapRegions.data(), sizeof(PointerMapRegion), mapRegions.size(), file) == mapRegions.size() &&
+    fwrite(names.data(), 1, names.size(), file) == names.size() &&
+    fwrite(entries, sizeof(PointerEntry), entryCount, file) == entryCount;
+  ok = fclose(file) == 0 && ok;
+  if (!ok) {
+    throw MedException("Failed to write " + filename);
+  }
+}
+
+void PointerScanner::load(const string& filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw MedException("Failed to open " + filename);
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(PointerMapHeader)) {
+    close(fd);
+    throw MedException("Invalid pointer map " + filename);
+  }
+  void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw MedException("Failed to map " + filename);
+  }
+
+  // Offsets and counts come from the file, so every sum is checked as a difference
+  auto header = (PointerMapHeader*)data;
+  size_t size = st.st_size;
+  bool valid = memcmp(header->magic, POINTER_MAP_MAGIC, sizeof(header->magic)) == 0 &&
+    header->version == POINTER_MAP_VERSION &&
+    (header->pointerSize == 4 || header->pointerSize == 8) &&
+    header->regionsOffset % alignof(PointerMapRegion) == 0 &&
+    header->entriesOffset % alignof(PointerEntry) == 0 &&
+    header->regionsOffset >= sizeof(PointerMapHeader) &&
+    header->regionsOffset <= header->namesOffset &&
+    header->namesOffset <= header->entriesOffset &&
+    header->entriesOffset <= size &&
+    header->regionCount <= (header->namesOffset - header->regionsOffset) / sizeof(PointerMapRegion) &&
+    header->entryCount <= (size - header->entriesOffset) / sizeof(PointerEntry);
+
+  auto mapRegions = (PointerMapRegion*)((Byte*)data + header->regionsOffset);
+  size_t namesSize = valid ? header->entriesOffset - header->namesOffset : 0;
+  for (size_t i = 0; valid && i < header->regionCount; i++) {
+    valid = mapRegions[i].nameOffset <= namesSize && mapRegions[i].nameLength <= namesSize - mapRegions[i].nameOffset;
+  }
+  if (!valid) {
+    munmap(data, size);
+    throw MedException("Invalid pointer map " + filename);
+  }
+
+  clear();
+  mapped = data;
+  mappedSize = size;
+  pointerSize = header->pointerSize;
+
+  const char* names = (const char*)data + header->namesOffset;
+  for (size_t i = 0; i < header->regionCount; i++) {
+    auto& region = mapRegions[i];
+    string name(names + region.nameOffset, region.nameLength);
+    regions.push_back({ region.start, region.end, (region.flags & 1) != 0, (region.flags & 2) != 0, name });
+  }
+
+  entries = (const PointerEntry*)((Byte*)data + header->entriesOffset);
+  entryCount = header->entryCount;
+}
+
+vector<PointerPath> PointerScanner::intersect(const vector<PointerRun>& runs, const PointerScanOptions& options) {
+  vector<PointerPath> paths;
+  MemIO memio;
+  for (size_t i = 0; i < runs.size(); i++) {
+    PointerScanner scanner(&memio);
+    scanner.load(runs[i].filename);
+    if (i == 0) {
+      paths = scanner.findPaths(runs[i].target, options);
+    }
+    else {
+      PointerScanOptions narrowing = options;
+      narrowing.maxResults = paths.size();
+      paths = scanner.findPaths(runs[i].target, paths, narrowing);
+    }
+    if (!paths.size()) {
+      break;
+    }
+  }
+  return paths;
+}
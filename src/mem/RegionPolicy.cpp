@@ -0,0 +1,97 @@
+#include <cerrno>
+#include <cstdlib> //strtoul()
+#include <fnmatch.h> //fnmatch()
+
+#include "mem/RegionPolicy.hpp"
+#include "med/MedException.hpp"
+
+using namespace std;
+
+static bool matchesAny(const vector<string>& globs, const string& pathname) {
+  for (auto& glob : globs) {
+    if (fnmatch(glob.c_str(), pathname.c_str(), 0) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RegionPolicy::accepts(const MapRegion& region) const {
+  if (anonymousOnly || heapOnly) {
+    bool anonymous = anonymousOnly && region.isAnonymous();
+    bool heap = heapOnly && region.pathname == "[heap]";
+    if (!anonymous && !heap) return false;
+  }
+  if (skipShared && region.shared) return false;
+  if (region.size() < minSize) return false;
+  if (maxSize && region.size() > maxSize) return false;
+  if (includes.size() && !matchesAny(includes, region.pathname)) return false;
+  if (matchesAny(excludes, region.pathname)) return false;
+  return true;
+}
+
+Maps RegionPolicy::select(Maps& maps) const {
+  Maps selected;
+  for (auto& region : maps.getRegions()) {
+    if (accepts(region)) {
+      selected.push(region);
+    }
+  }
+  return selected;
+}
+
+RegionPolicy RegionPolicy::preset(const string& name) {
+  RegionPolicy policy;
+  if (name == REGION_PRESET_ALL) {
+    return policy;
+  }
+  else if (name == REGION_PRESET_PRIVATE) {
+    policy.skipShared = true;
+    policy.excludes = { "/dev/*", "/memfd:*", "[vvar]", "[vdso]", "[vsyscall]" };
+  }
+  else if (name == REGION_PRESET_ANONYMOUS) {
+    policy.anonymousOnly = true;
+    policy.heapOnly = true;
+    policy.skipShared = true;
+  }
+  else if (name == REGION_PRESET_HEAP) {
+    policy.heapOnly = true;
+  }
+  else {
+    throw MedException(string("Unknown region preset: ") + name);
+  }
+  return policy;
+}
+
+vector<string> RegionPolicy::getPresetNames() {
+  return { REGION_PRESET_ALL, REGION_PRESET_PRIVATE, REGION_PRESET_ANONYMOUS, REGION_PRESET_HEAP };
+}
+
+// Decimal, or hexadecimal with "0x"
+static size_t parseSize(const string& arg) {
+  string number = arg.substr(4);
+  char* end;
+  errno = 0;
+  unsigned long size = strtoul(number.c_str(), &end, 0);
+  if (number.empty() || *end != '\0' || errno == ERANGE || number[0] == '-') {
+    throw MedException(string("Invalid region size: ") + arg);
+  }
+  return size;
+}
+
+RegionPolicy RegionPolicy::parse(const vector<string>& args) {
+  if (args.empty()) {
+    throw MedException("Missing region preset");
+  }
+  RegionPolicy policy = preset(args[0]);
+  for (size_t i = 1; i < args.size(); i++) {
+    auto& arg = args[i];
+    if (arg.empty()) continue;
+    else if (arg[0] == '+') policy.includes.push_back(arg.substr(1));
+    else if (arg[0] == '-') policy.excludes.push_back(arg.substr(1));
+    else if (arg.compare(0, 4, "min=") == 0) policy.minSize = parseSize(arg);
+    else if (arg.compare(0, 4, "max=") == 0) policy.maxSize = parseSize(arg);
+    else throw MedException(string("Unknown region option: ") + arg);
+  }
+  return policy;
+}
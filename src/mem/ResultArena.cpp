@@ -0,0 +1,37 @@
+#include <algorithm>
+#include "mem/ResultArena.hpp"
+
+ResultArena::ResultArena() {
+  next = NULL;
+  remaining = 0;
+  used = 0;
+}
+
+void* ResultArena::allocate(size_t size, size_t alignment) {
+  size_t padding = (alignment - (size_t)next % alignment) % alignment;
+  if (padding + size > remaining) {
+    // Chunk is allocated on the first hit, so that a task without hit costs nothing
+    size_t chunkSize = RESULT_ARENA_FIRST_CHUNK;
+    for (size_t i = 0; i < chunks.size() && chunkSize < RESULT_ARENA_LAST_CHUNK; i++) {
+      chunkSize *= 2;
+    }
+    chunkSize = max(chunkSize, size + alignment);
+    chunks.push_back(unique_ptr<Byte[]>(new Byte[chunkSize]));
+    next = chunks.back().get();
+    remaining = chunkSize;
+    padding = (alignment - (size_t)next % alignment) % alignment;
+  }
+  void* ptr = next + padding;
+  next += padding + size;
+  remaining -= padding + size;
+  used += size;
+  return ptr;
+}
+
+size_t ResultArena::getChunkCount() {
+  return chunks.size();
+}
+
+size_t ResultArena::getBytesUsed() {
+  return used;
+}
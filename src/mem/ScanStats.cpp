@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+#include "mem/ScanStats.hpp"
+
+using namespace std;
+
+void ScanStats::merge(const ScanStats& other) {
+  elapsedMs += other.elapsedMs;
+  bytesRequested += other.bytesRequested;
+  bytesRead += other.bytesRead;
+  pagesRead += other.pagesRead;
+  pagesUnreadable += other.pagesUnreadable;
+  pagesUnmapped += other.pagesUnmapped;
+  readsSkipped += other.readsSkipped;
+  readErrors += other.readErrors;
+  syscalls += other.syscalls;
+  matches += other.matches;
+  allocations += other.allocations;
+  listLockWaitMs += other.listLockWaitMs;
+  fdLockWaitMs += other.fdLockWaitMs;
+
+  workerBusyMs.resize(max(workerBusyMs.size(), other.workerBusyMs.size()), 0);
+  workerIdleMs.resize(max(workerIdleMs.size(), other.workerIdleMs.size()), 0);
+  for (size_t i = 0; i < other.workerBusyMs.size(); i++) {
+    workerBusyMs[i] += other.workerBusyMs[i];
+  }
+  for (size_t i = 0; i < other.workerIdleMs.size(); i++) {
+    workerIdleMs[i] += other.workerIdleMs[i];
+  }
+}
+
+string ScanStats::summary() const {
+  double busy = accumulate(workerBusyMs.begin(), workerBusyMs.end(), 0.0);
+  double idle = accumulate(workerIdleMs.begin(), workerIdleMs.end(), 0.0);
+  bool isSnapshot = operation == "snapshot"; // Saves the pages, nothing is matched
+  char line[256];
+  snprintf(line, sizeof(line),
+           "%s: %zu %s in %.0f ms, read %.1f of %.1f MB, %zu syscalls, %zu errors, busy %.0f%%, lock wait %.0f ms",
+           operation.c_str(), isSnapshot ? pagesRead : matches, isSnapshot ? "pages saved" : "matches",
+           elapsedMs, bytesRead / 1e6, bytesRequested / 1e6, syscalls, readErrors,
+           busy + idle > 0 ? busy * 100 / (busy + idle) : 0.0, listLockWaitMs + fdLockWaitMs);
+  return line;
+}
+
+string ScanStats::toString() const {
+  char text[1024];
+  int length = snprintf(text, sizeof(text),
+                        "%s\n"
+                        "  elapsed          %.3f ms\n"
+                        "  bytes            %zu read of %zu requested\n"
+                        "  pages            %zu read, %zu unreadable, %zu unmapped\n"
+                        "  reads            %zu skipped, %zu errors, %zu syscalls\n"
+                        "  matches          %zu\n"
+                        "  allocations      %zu\n"
+                        "  lock wait        %.3f ms list, %.3f ms fd\n",
+                        operation.c_str(), elapsedMs, bytesRead, bytesRequested,
+                        pagesRead, pagesUnreadable, pagesUnmapped,
+                        readsSkipped, readErrors, syscalls, matches, allocations,
+                        listLockWaitMs, fdLockWaitMs);
+  string result(text, min((size_t)length, sizeof(text) - 1));
+  for (size_t i = 0; i < workerBusyMs.size(); i++) {
+    snprintf(text, sizeof(text), "  worker %-9zu %.3f ms busy, %.3f ms idle\n",
+             i, workerBusyMs[i], i < workerIdleMs.size() ? workerIdleMs[i] : 0.0);
+    result += text;
+  }
+  return result;
+}
+
+double elapsedMs(const chrono::steady_clock::time_point& start) {
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
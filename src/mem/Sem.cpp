@@ -6,6 +6,7 @@ Sem::Sem(PemPtr pem) : Pem(pem->getSize(), pem->getMemIO()) {
   setAddress(pem->getAddress());
   setScanType(pem->getScanType());
   locked = false;
+  hasExpression = false;
   description = "No description";
 }
 
@@ -15,14 +16,18 @@ Sem::Sem(Sem& sem) : Pem(sem.getSize(), sem.getMemIO()) {
   setScanType(sem.getScanType());
   locked = false;
   description = sem.getDescription();
+  hasExpression = sem.hasAddressExpression();
+  addressExpression = sem.getAddressExpression();
 }
 
 Sem::Sem(size_t size, MemIO* memio) : Pem(size, memio) {
   locked = false;
+  hasExpression = false;
 }
 
 Sem::Sem(Address addr, size_t size, MemIO* memio) : Pem(addr, size, memio) {
   locked = false;
+  hasExpression = false;
 }
 
 bool Sem::isLocked() {
@@ -44,16 +49,62 @@ void Sem::setDescription(string s) {
   description = s;
 }
 
+bool Sem::hasAddressExpression() {
+  return hasExpression;
+}
+
+AddressExpression& Sem::getAddressExpression() {
+  return addressExpression;
+}
+
+void Sem::setAddressExpression(const string& expression) {
+  AddressExpression parsed = AddressExpression::parse(expression);
+  if (parsed.isAbsolute()) {
+    clearAddressExpression();
+    setAddress(parsed.base);
+    return;
+  }
+  addressExpression = parsed;
+  hasExpression = true;
+}
+
+void Sem::clearAddressExpression() {
+  hasExpression = false;
+  addressExpression = AddressExpression();
+}
+
+void Sem::shiftAddress(long diff) {
+  setAddress(getAddress() + diff);
+  if (!hasExpression) return;
+  if (addressExpression.offsets.size()) {
+    addressExpression.offsets.back() += diff;
+  }
+  else {
+    addressExpression.base += diff;
+  }
+}
+
 void Sem::setLockedValue(string s) {
   lockedValue = s;
+  lockedScanType = getScanType();
+  lockedBytes = Pem::stringToBytes(lockedValue, lockedScanType);
 }
 
 string& Sem::getLockedValue() {
   return lockedValue;
 }
 
+SizedBytes& Sem::getLockedBytes() {
+  if (lockedScanType != getScanType()) { // Type changed after locking
+    setLockedValue(lockedValue);
+  }
+  return lockedBytes;
+}
+
 void Sem::lockValue() {
-  setValue(getLockedValue(), getScanType());
+  SizedBytes& bytes = getLockedBytes();
+  MemSegments segments = { { address, bytes.getBytes(), bytes.getSize(), false } };
+  getMemIO()->writeBatch(segments);
 }
 
 SemPtr Sem::clone(SemPtr semPtr) {
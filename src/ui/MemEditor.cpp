@@ -5,6 +5,7 @@
 #include <string>
 #include <iostream>
 #include <cctype>
+#include <cstring>
 
 #include <QWidget>
 #include <QtUiTools>
@@ -16,6 +17,7 @@
 #include "med/MemOperator.hpp"
 #include "med/MedCommon.hpp"
 #include "med/MedException.hpp"
+#include "med/Tracer.hpp"
 #include "mem/Pem.hpp"
 
 using namespace std;
@@ -25,6 +27,8 @@ MemEditor::MemEditor(MedUi* mainUi) : QWidget(NULL, Qt::SubWindow) {
   this->med = mainUi->med;
   rawMemory = NULL;
   baseAddress = 0;
+  watchedAddress = 0;
+  lastAddress = 0;
 
   QUiLoader loader;
   QFile file("./mem-editor.ui");
@@ -88,6 +92,11 @@ void MemEditor::setupSignals() {
                    SIGNAL(clicked()),
                    this,
                    SLOT(onEnterClicked()));
+  QObject::connect(this,
+                   SIGNAL(memoryRead(quint64, QByteArray)),
+                   this,
+                   SLOT(onMemoryRead(quint64, QByteArray)),
+                   Qt::QueuedConnection);
 }
 
 
@@ -104,6 +113,7 @@ void MemEditor::onCurrAddressEdited() {
 
   try {
     baseAddress = addressRoundDown(hexToInt(addr.toStdString()));
+    watchedAddress = baseAddress;
     loadMemory(baseAddress);
     loadAddresses(baseAddress);
     currAddress->setText(addr);
@@ -132,9 +142,13 @@ void MemEditor::updateAddresses() {
 
 void MemEditor::loadMemory(Address address, size_t size) {
   MemPtr mem = med->readMemory(address, size);
-  memHex = memoryToHex(mem->getData(), size);
-  string textView = memoryToString(mem->getData(), size, mainUi->encodingManager);
-  storeRawMemory(mem->getData(), size);
+  showMemory(mem->getData(), size);
+}
+
+void MemEditor::showMemory(Byte* memory, size_t size) {
+  memHex = memoryToHex(memory, size);
+  string textView = memoryToString(memory, size, mainUi->encodingManager);
+  storeRawMemory(memory, size);
 
   memArea->setPlainText(QString(memHex.c_str()));
   textArea->setPlainText(QString(textView.c_str()));
@@ -273,8 +287,59 @@ void MemEditor::onRefreshButtonClicked() {
   refresh();
 }
 
+void MemEditor::showEvent(QShowEvent* event) {
+  QWidget::showEvent(event);
+  med->getScheduler()->subscribe(this, MIN_REFRESH_RATE, REFRESH_RATE);
+}
+
+void MemEditor::hideEvent(QHideEvent* event) {
+  med->getScheduler()->unsubscribe(this);
+  QWidget::hideEvent(event);
+}
+
+void MemEditor::collect(vector<MemRange>& reads) {
+  Address address = watchedAddress;
+  if (address) {
+    reads.push_back({ address, MEMORY_SIZE });
+  }
+}
+
+bool MemEditor::deliver(const MemSegments& results, MemSegments& writes) {
+  TraceSpan span("refresh", "ui", "bytes", results.size() ? results[0].size : 0);
+  if (!results.size() || !results[0].ok) {
+    return false;
+  }
+  auto& result = results[0];
+  if (result.address == lastAddress && lastMemory.size() == result.size &&
+      memcmp(lastMemory.data(), result.buffer, result.size) == 0) {
+    return false;
+  }
+  lastAddress = result.address;
+  lastMemory.assign(result.buffer, result.buffer + result.size);
+
+  emit memoryRead((quint64)result.address, QByteArray((const char*)result.buffer, result.size));
+  return true;
+}
+
+// Like refresh(), but keep the cursor without taking the focus
+void MemEditor::onMemoryRead(quint64 address, QByteArray memory) {
+  if (address != baseAddress || memory.size() != MEMORY_SIZE) {
+    return;
+  }
+  QString addr = currAddress->text();
+  int position = memArea->textCursor().position();
+
+  showMemory((Byte*)memory.data(), memory.size());
+
+  auto cursor = memArea->textCursor();
+  cursor.setPosition(position, QTextCursor::MoveAnchor);
+  memArea->setTextCursor(cursor);
+  currAddress->setText(addr);
+}
+
 void MemEditor::setBaseAddress(Address addr) {
   baseAddress = addr;
+  watchedAddress = addr;
 }
 
 Address MemEditor::getBaseAddress() {
@@ -42,6 +42,19 @@ void NamedScansController::onAddClicked() {
   selectByName(trimmed);
 }
 
+void NamedScansController::reload() {
+  comboBox->blockSignals(true);
+  comboBox->clear();
+  for (auto& name : namedScans->getNames()) {
+    comboBox->addItem(QString(name.c_str()));
+  }
+  comboBox->setCurrentIndex(comboBox->findText(QString(namedScans->getActiveName().c_str())));
+  comboBox->blockSignals(false);
+
+  updateScanTree();
+  updateScanType();
+}
+
 void NamedScansController::selectByName(string name) {
   auto trimmed = StringUtil::trim(name);
   int index = comboBox->findText(QString(trimmed.c_str()));
@@ -74,17 +87,17 @@ void NamedScansController::updateScanTree() {
   auto count = namedScans->getMemList()->size();
   mainUi->updateNumberOfAddresses();
 
-  mainUi->scanUpdateMutex->lock();
+  mainUi->scanUpdateMutex.lock();
   mainUi->scanModel->clearAll();
-  mainUi->scanUpdateMutex->unlock();
+  mainUi->scanUpdateMutex.unlock();
 
   if (count > SCAN_ADDRESS_VISIBLE_SIZE) {
     return;
   }
 
-  mainUi->scanUpdateMutex->lock();
+  mainUi->scanUpdateMutex.lock();
   mainUi->scanModel->addScan(namedScans->getScanType());
-  mainUi->scanUpdateMutex->unlock();
+  mainUi->scanUpdateMutex.unlock();
 }
 
 void NamedScansController::updateScanType() {
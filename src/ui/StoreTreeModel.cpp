@@ -22,6 +22,7 @@ StoreTreeModel::StoreTreeModel(MedUi* mainUi, QObject* parent) : TreeModel(mainU
 
   this->mainUi = mainUi;
   this->med = mainUi->med;
+  valueColumn = STORE_COL_VALUE;
 }
 
 StoreTreeModel::~StoreTreeModel() {
@@ -32,6 +33,12 @@ QVariant StoreTreeModel::data(const QModelIndex &index, int role) const {
   if (!index.isValid())
     return QVariant();
 
+  if (role == Qt::ToolTipRole && index.column() == STORE_COL_LOCK &&
+      index.row() < (int)med->getStore()->size()) {
+    Address address = med->getStore()->getAddress(index.row());
+    return QString("Reverted %1 times").arg(med->getLockRevertCount(address));
+  }
+
   if (role != Qt::DisplayRole && role != Qt::EditRole)
     return QVariant();
 
@@ -59,11 +66,12 @@ bool StoreTreeModel::setData(const QModelIndex &index, const QVariant &value, in
     setAddress(index, value);
   }
   else if (index.column() == STORE_COL_LOCK) {
-    auto sem = static_pointer_cast<Sem>(med->getStore()->getList()[index.row()]);
+    auto sem = static_pointer_cast<Sem>(med->getStore()->getMemPtr(index.row()));
     sem->lock(value.toBool());
+    med->lockValues(); // Apply to the freezer without waiting for the next sync
   }
   else if (index.column() == STORE_COL_DESCRIPTION) {
-    auto sem = static_pointer_cast<Sem>(med->getStore()->getList()[index.row()]);
+    auto sem = static_pointer_cast<Sem>(med->getStore()->getMemPtr(index.row()));
     sem->setDescription(value.toString().toStdString());
   }
 
@@ -72,6 +80,9 @@ bool StoreTreeModel::setData(const QModelIndex &index, const QVariant &value, in
   if (result) {
     emit dataChanged(index, index);
   }
+  if (index.column() == STORE_COL_VALUE) {
+    emit valueEdited(index);
+  }
 
   return result;
 }
@@ -89,22 +100,8 @@ Qt::ItemFlags StoreTreeModel::flags(const QModelIndex &index) const {
   return flags;
 }
 
-void StoreTreeModel::refreshValues() {
-  if (rowCount() == 0)
-    return;
-  QModelIndex first = index(0, STORE_COL_VALUE);
-  QModelIndex last = index(rowCount() - 1, STORE_COL_VALUE);
-
-  auto store = med->getStore();
-  for (int i = 0; i < rowCount(); i++) {
-    string value;
-    try {
-      value = store->getValue(i);
-    } catch(MedException &ex) {}
-    QModelIndex modelIndex = index(i, STORE_COL_VALUE);
-    setItemData(modelIndex, QString::fromStdString(value));
-  }
-  emit dataChanged(first, last);
+MemList StoreTreeModel::getRefreshList() {
+  return *med->getStore();
 }
 
 void StoreTreeModel::refresh() {
@@ -119,8 +116,11 @@ void StoreTreeModel::refresh() {
       cerr << "Exception throw in refresh" << endl;
     }
 
-    auto sem = static_pointer_cast<Sem>(med->getStore()->getList()[i]);
+    auto sem = static_pointer_cast<Sem>(med->getStore()->getMemPtr(i));
     string description = sem->getDescription();
+    if (sem->hasAddressExpression()) {
+      address = sem->getAddressExpression().toString(); // Shown instead of the resolved address
+    }
     bool lock = sem->isLocked();
 
     QVector<QVariant> data;
@@ -146,8 +146,11 @@ void StoreTreeModel::addRow() {
     cerr << "Add row no value" << endl;
   }
 
-  auto sem = static_pointer_cast<Sem>(med->getStore()->getList()[lastIndex]);
+  auto sem = static_pointer_cast<Sem>(med->getStore()->getMemPtr(lastIndex));
   string description = sem->getDescription();
+  if (sem->hasAddressExpression()) {
+    address = sem->getAddressExpression().toString();
+  }
   bool lock = sem->isLocked();
 
   QVector<QVariant> data;
@@ -182,6 +185,7 @@ void StoreTreeModel::setValue(const QModelIndex &index, const QVariant &value) {
     string newValue = encodeString(value.toString().toStdString(), scanType);
 
     med->getStore()->setValue(row, newValue, scanType, true);
+    med->lockValues();
   } catch(MedException &e) {
     cerr << "editStoreValue: " << e.what() << endl;
   }
@@ -203,7 +207,7 @@ void StoreTreeModel::setType(const QModelIndex &index, const QVariant &value) {
 void StoreTreeModel::setAddress(const QModelIndex &index, const QVariant &value) {
   int row = index.row();
   try {
-    med->getStore()->setAddress(row, value.toString().toStdString());
+    med->setStoreAddress(row, value.toString().toStdString());
     string value2 = med->getStore()->getValue(row);
     QVariant valueToSet = QString::fromStdString(value2);
 
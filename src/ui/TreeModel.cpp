@@ -3,6 +3,7 @@
 #include <cstdio>
 
 #include "med/MedException.hpp"
+#include "med/Tracer.hpp"
 #include "ui/Ui.hpp"
 #include "ui/EncodingManager.hpp"
 #include "ui/TreeItem.hpp"
@@ -17,6 +18,25 @@ TreeModel::TreeModel(MedUi* mainUi, QObject* parent) : QAbstractItemModel(parent
 
   this->mainUi = mainUi;
   this->med = mainUi->med;
+
+  valueColumn = SCAN_COL_VALUE;
+  refreshFirst = 0;
+  refreshLast = 0;
+  refreshPaused = false;
+  refreshRequested = false;
+  generation = 0;
+  editing = false;
+  valuesDropped = false;
+  refreshFrom = 0;
+  refreshGeneration = 0;
+  lastFrom = -1;
+
+  // Values are read in the scheduler thread, but the items are updated in the UI thread
+  QObject::connect(this,
+                   SIGNAL(valuesRead(int, QStringList, int)),
+                   this,
+                   SLOT(onValuesRead(int, QStringList, int)),
+                   Qt::QueuedConnection);
 }
 
 TreeModel::~TreeModel() {
@@ -57,6 +77,9 @@ bool TreeModel::setData(const QModelIndex &index, const QVariant &value, int rol
   if (result) {
     emit dataChanged(index, index);
   }
+  if (index.column() == SCAN_COL_VALUE) {
+    emit valueEdited(index);
+  }
 
   return result;
 }
@@ -136,6 +159,7 @@ bool TreeModel::removeColumns(int position, int columns, const QModelIndex &pare
 
 bool TreeModel::removeRows(int position, int rows, const QModelIndex &parent) {
   TreeItem *parentItem = getItem(parent);
+  generation++;
 
   beginRemoveRows(parent, position, position + rows - 1);
   bool success = parentItem->removeChildren(position, rows);
@@ -211,19 +235,98 @@ void TreeModel::addScan(string scanType) {
   }
 }
 
-void TreeModel::refreshValues() {
-  if (rowCount() == 0) {
+void TreeModel::setRefreshRows(int first, int last) {
+  refreshFirst = first;
+  refreshLast = last;
+}
+
+void TreeModel::setRefreshPaused(bool paused) {
+  refreshPaused = paused;
+}
+
+void TreeModel::requestRefresh() {
+  refreshRequested = true;
+}
+
+void TreeModel::setEditing(bool editing) {
+  this->editing = editing;
+  if (!editing) {
+    requestRefresh();
+  }
+}
+
+MemList TreeModel::getRefreshList() {
+  return med->getScans();
+}
+
+void TreeModel::collect(vector<MemRange>& reads) {
+  if (!refreshRequested.exchange(false) && refreshPaused) {
+    refreshList.clear();
     return;
   }
-  QModelIndex first = index(0, SCAN_COL_VALUE);
-  QModelIndex last = index(rowCount() - 1, SCAN_COL_VALUE);
-  auto scans = med->getScans();
-  for (int i = 0; i < rowCount(); i++) {
-    string value = scans.getValue(i);
-    QModelIndex modelIndex = index(i, SCAN_COL_VALUE);
-    setItemData(modelIndex, QString::fromStdString(value));
+  refreshList = getRefreshList();
+  refreshFrom = refreshFirst;
+  refreshGeneration = generation;
+  vector<MemRange> ranges = refreshList.getRanges(refreshFrom, refreshLast);
+  reads.insert(reads.end(), ranges.begin(), ranges.end());
+}
+
+bool TreeModel::deliver(const MemSegments& results, MemSegments& writes) {
+  TraceSpan span("refresh", "ui", "rows", results.size());
+  if (!results.size() || editing) {
+    return false;
+  }
+  vector<string> values = refreshList.getValues(refreshFrom, results);
+  bool dropped = valuesDropped.exchange(false);
+  if (!dropped && refreshFrom == lastFrom && values == lastValues) {
+    return false;
+  }
+  lastFrom = refreshFrom;
+  lastValues = values;
+
+  QStringList strings;
+  for (size_t i = 0; i < values.size(); i++) {
+    string value = convertToUtf8(values[i], refreshList.getScanType(refreshFrom + i));
+    strings << QString::fromStdString(value);
+  }
+  emit valuesRead(refreshFrom, strings, refreshGeneration);
+  return true;
+}
+
+/**
+ * Only notify the view about the rows with value changed.
+ * Consecutive changed rows are notified together.
+ */
+void TreeModel::onValuesRead(int first, QStringList values, int generation) {
+  if (generation != this->generation) {
+    return;
+  }
+  if (editing) { // Queued before the edit started, the editor must not be overwritten
+    valuesDropped = true;
+    return;
+  }
+
+  int last = std::min(first + values.size(), rowCount());
+  int changedFrom = -1;
+  for (int i = first; i <= last; i++) {
+    bool changed = false;
+    if (i < last) {
+      QVariant newValue = values[i - first];
+      TreeItem* item = getItem(index(i, valueColumn));
+      if (item != rootItem && item->data(valueColumn) != newValue) {
+        item->setData(valueColumn, newValue);
+        changed = true;
+      }
+    }
+
+    if (changed && changedFrom < 0) {
+      changedFrom = i;
+    }
+    else if (!changed && changedFrom >= 0) {
+      emit dataChanged(index(changedFrom, valueColumn), index(i - 1, valueColumn));
+      changedFrom = -1;
+    }
   }
-  emit dataChanged(first, last);
 }
 
 void TreeModel::empty() {
@@ -1,8 +1,10 @@
 #include <cstdio>
 #include <iostream>
+#include <climits>
 
 #include <QtUiTools>
 #include <QtDebug>
+#include <QScrollBar>
 
 #include "med/MedException.hpp"
 #include "med/MedCommon.hpp"
@@ -22,7 +24,6 @@ MedUi::MedUi(QApplication* app) {
   this->autoRefresh = true;
   this->fastScan = true;
   med = new MemEd();
-  scanUpdateMutex = &med->getScanListMutex();
 
   loadUiFiles();
   loadProcessUi();
@@ -44,9 +45,6 @@ MedUi::~MedUi() {
   delete med;
   delete encodingManager;
   delete namedScansController;
-
-  refreshThread->join();
-  delete refreshThread;
 }
 
 void MedUi::loadUiFiles() {
@@ -97,10 +95,17 @@ void MedUi::loadMemEditor() {
 
 void MedUi::setupUi() {
   scanTypeCombo->setCurrentIndex(2); // int32
+  auto regionPolicyCombo = mainWindow->findChild<QComboBox*>("regionPolicy");
+  for (auto& name : RegionPolicy::getPresetNames()) {
+    regionPolicyCombo->addItem(QString::fromStdString(name));
+  }
   mainWindow->show();
   qRegisterMetaType<QVector<int>>(); // For multithreading
 
-  refreshThread = new std::thread(MedUi::refresh, this);
+  updateRefreshRows(scanTreeView, scanModel);
+  updateRefreshRows(storeTreeView, storeModel);
+  med->getScheduler()->subscribe(scanModel, MIN_REFRESH_RATE, REFRESH_RATE);
+  med->getScheduler()->subscribe(storeModel, MIN_REFRESH_RATE, REFRESH_RATE);
 
   QAction* showNotesAction = mainWindow->findChild<QAction*>("actionShowNotes");
   if (showNotesAction->isChecked()) {
@@ -163,6 +168,14 @@ void MedUi::setupSignals() {
                    SIGNAL(triggered()),
                    this,
                    SLOT(onSaveTriggered()));
+  QObject::connect(mainWindow->findChild<QAction*>("actionSaveSession"),
+                   SIGNAL(triggered()),
+                   this,
+                   SLOT(onSaveSessionTriggered()));
+  QObject::connect(mainWindow->findChild<QAction*>("actionOpenSession"),
+                   SIGNAL(triggered()),
+                   this,
+                   SLOT(onOpenSessionTriggered()));
   QObject::connect(mainWindow->findChild<QAction*>("actionQuit"),
                    SIGNAL(triggered()),
                    this,
@@ -196,6 +209,10 @@ void MedUi::setupSignals() {
                    SIGNAL(triggered(bool)),
                    this,
                    SLOT(onFastScanTriggered(bool)));
+  QObject::connect(mainWindow->findChild<QAction*>("actionScanNewRegions"),
+                   SIGNAL(triggered(bool)),
+                   this,
+                   SLOT(onScanNewRegionsTriggered(bool)));
 
   QObject::connect(mainWindow->findChild<QPushButton*>("nextAddress"),
                    SIGNAL(clicked()),
@@ -242,6 +259,10 @@ void MedUi::setupSignals() {
                    SIGNAL(editingFinished()),
                    this,
                    SLOT(onScopeEndEdited()));
+  QObject::connect(mainWindow->findChild<QComboBox*>("regionPolicy"),
+                   SIGNAL(currentIndexChanged(QString)),
+                   this,
+                   SLOT(onRegionPolicyChanged(QString)));
 }
 
 void MedUi::setupScanTreeView() {
@@ -251,6 +272,14 @@ void MedUi::setupScanTreeView() {
   scanTreeView->setUniformRowHeights(true);
   ComboBoxDelegate* delegate = new ComboBoxDelegate();
   scanTreeView->setItemDelegateForColumn(SCAN_COL_TYPE, delegate);
+  QObject::connect(scanTreeView->verticalScrollBar(),
+                   SIGNAL(valueChanged(int)),
+                   this,
+                   SLOT(onScanTreeViewScrolled()));
+  QObject::connect(scanTreeView->verticalScrollBar(), // Rows added or removed, view resized
+                   SIGNAL(rangeChanged(int, int)),
+                   this,
+                   SLOT(onScanTreeViewScrolled()));
   QObject::connect(scanTreeView,
                    SIGNAL(clicked(QModelIndex)),
                    this,
@@ -261,9 +290,9 @@ void MedUi::setupScanTreeView() {
                    SLOT(onScanTreeViewDoubleClicked(QModelIndex)));
 
   QObject::connect(scanModel,
-                   SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)),
+                   SIGNAL(valueEdited(QModelIndex)),
                    this,
-                   SLOT(onScanTreeViewDataChanged(QModelIndex, QModelIndex, QVector<int>)));
+                   SLOT(onScanValueEdited(QModelIndex)));
   scanTreeView->setSelectionMode(QAbstractItemView::ExtendedSelection);
 }
 
@@ -276,6 +305,14 @@ void MedUi::setupStoreTreeView() {
   storeTreeView->setItemDelegateForColumn(STORE_COL_TYPE, storeDelegate);
   CheckBoxDelegate* storeLockDelegate = new CheckBoxDelegate();
   storeTreeView->setItemDelegateForColumn(STORE_COL_LOCK, storeLockDelegate);
+  QObject::connect(storeTreeView->verticalScrollBar(),
+                   SIGNAL(valueChanged(int)),
+                   this,
+                   SLOT(onStoreTreeViewScrolled()));
+  QObject::connect(storeTreeView->verticalScrollBar(),
+                   SIGNAL(rangeChanged(int, int)),
+                   this,
+                   SLOT(onStoreTreeViewScrolled()));
   QObject::connect(storeTreeView,
                    SIGNAL(clicked(QModelIndex)),
                    this,
@@ -286,9 +323,9 @@ void MedUi::setupStoreTreeView() {
                    SLOT(onStoreTreeViewDoubleClicked(QModelIndex)));
 
   QObject::connect(storeModel,
-                   SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)),
+                   SIGNAL(valueEdited(QModelIndex)),
                    this,
-                   SLOT(onStoreTreeViewDataChanged(QModelIndex, QModelIndex, QVector<int>)));
+                   SLOT(onStoreValueEdited(QModelIndex)));
 
   auto* header = storeTreeView->header();
   header->setSectionsClickable(true);
@@ -342,9 +379,9 @@ void MedUi::onScanClicked() {
     scanValue = encodingManager->encode(scanValue);
   }
 
-  scanUpdateMutex->lock();
+  scanUpdateMutex.lock();
   scanModel->clearAll();
-  scanUpdateMutex->unlock();
+  scanUpdateMutex.unlock();
 
   try {
     med->scan(scanValue, scanType, fastScan, getLastDigit());
@@ -357,14 +394,12 @@ void MedUi::onScanClicked() {
   }
 
   if(med->getScans().size() <= SCAN_ADDRESS_VISIBLE_SIZE) {
-    scanUpdateMutex->lock();
+    scanUpdateMutex.lock();
     scanModel->addScan(scanType);
-    scanUpdateMutex->unlock();
+    scanUpdateMutex.unlock();
   }
 
-  if (QString(scanValue.c_str()).trimmed() == "?") {
-    statusBar->showMessage("Snapshot saved");
-  }
+  showScanStats();
   updateNumberOfAddresses();
   if (!med->getIsProcessPaused() && med->getCanResumeProcess()) {
     med->resumeProcess();
@@ -402,12 +437,19 @@ void MedUi::onFilterClicked() {
     scanModel->addScan(scanType);
   }
 
+  showScanStats();
   updateNumberOfAddresses();
   if (!med->getIsProcessPaused() && med->getCanResumeProcess()) {
     med->resumeProcess();
   }
 }
 
+void MedUi::showScanStats() {
+  ScanStats stats = med->getLastScanStats();
+  statusBar->showMessage(QString::fromStdString(stats.summary()));
+  statusBar->setToolTip(QString::fromStdString(stats.toString()));
+}
+
 void MedUi::onPauseCheckboxClicked(bool checked) {
   if (checked) {
     med->pauseProcess();
@@ -426,23 +468,21 @@ void MedUi::onScanTreeViewClicked(const QModelIndex &index) {
 
 void MedUi::onScanTreeViewDoubleClicked(const QModelIndex &index) {
   if (index.column() == SCAN_COL_VALUE) {
-    scanUpdateMutex->lock();
+    scanUpdateMutex.lock();
     setScanState(UiState::Editing);
   }
 }
 
-void MedUi::onScanTreeViewDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles) {
-  // qDebug() << topLeft << bottomRight << roles;
-  if (topLeft.column() == SCAN_COL_VALUE) {
-    tryUnlock(*scanUpdateMutex);
-    setScanState(UiState::Idle);
-  }
+// Only the edit ends it, the refreshed values are not edits
+void MedUi::onScanValueEdited(const QModelIndex&) {
+  tryUnlock(scanUpdateMutex);
+  setScanState(UiState::Idle);
 }
 
 void MedUi::onStoreTreeViewDoubleClicked(const QModelIndex &index) {
   if (index.column() == STORE_COL_VALUE) {
     storeUpdateMutex.lock();
-    storeState = UiState::Editing;
+    setStoreState(UiState::Editing);
   }
 }
 
@@ -455,11 +495,9 @@ void MedUi::onStoreTreeViewClicked(const QModelIndex &index) {
   }
 }
 
-void MedUi::onStoreTreeViewDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles) {
-  if (topLeft.column() == STORE_COL_VALUE) {
-    tryUnlock(storeUpdateMutex);
-    storeState = UiState::Idle;
-  }
+void MedUi::onStoreValueEdited(const QModelIndex&) {
+  tryUnlock(storeUpdateMutex);
+  setStoreState(UiState::Idle);
 }
 
 void MedUi::onScanAddClicked() {
@@ -467,28 +505,28 @@ void MedUi::onScanAddClicked() {
     ->selectionModel()
     ->selectedRows(SCAN_COL_ADDRESS);
 
-  scanUpdateMutex->lock();
+  scanUpdateMutex.lock();
   for (int i = 0; i < indexes.size(); i++) {
     med->addToStoreByIndex(indexes[i].row());
   }
 
   storeModel->refresh();
-  scanUpdateMutex->unlock();
+  scanUpdateMutex.unlock();
 }
 
 void MedUi::onScanAddAllClicked() {
-  scanUpdateMutex->lock();
+  scanUpdateMutex.lock();
   for (size_t i = 0; i < med->getScans().size(); i++) {
     med->addToStoreByIndex(i);
   }
   storeModel->refresh();
-  scanUpdateMutex->unlock();
+  scanUpdateMutex.unlock();
 }
 
 void MedUi::onScanClearClicked() {
-  scanUpdateMutex->lock();
+  scanUpdateMutex.lock();
   scanModel->empty();
-  scanUpdateMutex->unlock();
+  scanUpdateMutex.unlock();
   statusBar->showMessage("Scan cleared");
 }
 
@@ -626,14 +664,20 @@ void MedUi::onSaveAsTriggered() {
     statusBar->showMessage("No process selected");
     return;
   }
+  QString tableFilter = QString("Binary table (*") + STORE_TABLE_EXTENSION.c_str() + ")";
+  QString selectedFilter;
   QString filename = QFileDialog::getSaveFileName(mainWindow,
                                                   QString("Save JSON"),
                                                   "./",
-                                                  QString("Save JSON (*.json)"));
+                                                  QString("Save JSON (*.json);;") + tableFilter,
+                                                  &selectedFilter);
 
   if (filename == "") {
     return;
   }
+  if (selectedFilter == tableFilter && !filename.endsWith(STORE_TABLE_EXTENSION.c_str())) {
+    filename += STORE_TABLE_EXTENSION.c_str();
+  }
   this->filename = filename;
   setWindowTitle();
 
@@ -648,7 +692,7 @@ void MedUi::onOpenTriggered() {
   QString filename = QFileDialog::getOpenFileName(mainWindow,
                                                   QString("Open JSON"),
                                                   "./",
-                                                  QString("Open JSON (*.json)"));
+                                                  QString("Open JSON (*.json *") + STORE_TABLE_EXTENSION.c_str() + ")");
   if (filename == "") {
     return;
   }
@@ -699,6 +743,38 @@ void MedUi::onSaveTriggered() {
   statusBar->showMessage("Saved");
 }
 
+void MedUi::onSaveSessionTriggered() {
+  QString filename = QFileDialog::getSaveFileName(mainWindow,
+                                                  QString("Save Scan Session"),
+                                                  "./",
+                                                  QString("Scan Session (*.medscans)"));
+  if (filename == "") {
+    return;
+  }
+  try {
+    med->saveSession(filename.toStdString());
+    statusBar->showMessage("Scan session saved");
+  } catch (MedException &ex) {
+    statusBar->showMessage(QString::fromStdString(ex.getMessage()));
+  }
+}
+
+void MedUi::onOpenSessionTriggered() {
+  QString filename = QFileDialog::getOpenFileName(mainWindow,
+                                                  QString("Open Scan Session"),
+                                                  "./",
+                                                  QString("Scan Session (*.medscans)"));
+  if (filename == "") {
+    return;
+  }
+  try {
+    med->openSession(filename.toStdString());
+  } catch (MedException &ex) {
+    statusBar->showMessage(QString::fromStdString(ex.getMessage()));
+    return;
+  }
+  namedScansController->reload();
+}
 
 ////// End Menu > File ////////////
 
@@ -717,6 +793,8 @@ void MedUi::onAutoRefreshTriggered(bool checked) {
   } else {
     autoRefresh = false;
   }
+  scanModel->setRefreshPaused(!autoRefresh);
+  storeModel->setRefreshPaused(!autoRefresh);
 }
 
 void MedUi::onFastScanTriggered(bool checked) {
@@ -727,6 +805,10 @@ void MedUi::onFastScanTriggered(bool checked) {
   }
 }
 
+void MedUi::onScanNewRegionsTriggered(bool checked) {
+  med->setScanNewRegions(checked);
+}
+
 void MedUi::onResumeProcessTriggered(bool checked) {
   if (checked) {
     med->setCanResumeProcess(true);
@@ -788,42 +870,33 @@ void MedUi::updateNumberOfAddresses() {
   mainWindow->findChild<QLabel*>("found")->setText(message);
 }
 
-void MedUi::refresh(MedUi* mainUi) {
-  // TODO: Store refresh if closing
-  while (1) {
-    if (mainUi->autoRefresh) {
-      mainUi->refreshScanTreeView();
-      mainUi->refreshStoreTreeView();
-    }
-    std::this_thread::sleep_for(chrono::milliseconds(REFRESH_RATE));
-  }
+void MedUi::onRefreshTriggered() {
+  scanModel->requestRefresh();
+  storeModel->requestRefresh();
+  med->getScheduler()->wake(scanModel);
+  med->getScheduler()->wake(storeModel);
 }
 
-void MedUi::onRefreshTriggered() {
-  refreshScanTreeView();
-  refreshStoreTreeView();
+pair<int, int> MedUi::getVisibleRows(QTreeView* view) {
+  int first = view->indexAt(QPoint(0, 0)).row();
+  int last = view->indexAt(QPoint(0, view->viewport()->height() - 1)).row();
+  first = first < 0 ? 0 : std::max(first - REFRESH_MARGIN, 0);
+  last = last < 0 ? INT_MAX : last + REFRESH_MARGIN; // Negative if the rows do not fill the view
+  return make_pair(first, last);
 }
 
-void MedUi::refreshScanTreeView() {
-  scanUpdateMutex->lock();
-  try {
-    scanModel->refreshValues();
-  } catch (MedException& ex) {
-    scanUpdateMutex->unlock();
-    cerr << ex.getMessage() << endl;
-  }
-  scanUpdateMutex->unlock();
+void MedUi::updateRefreshRows(QTreeView* view, TreeModel* model) {
+  auto rows = getVisibleRows(view);
+  model->setRefreshRows(rows.first, rows.second);
+  med->getScheduler()->wake(model);
 }
 
-void MedUi::refreshStoreTreeView() {
-  storeUpdateMutex.lock();
-  try {
-    storeModel->refreshValues();
-  } catch (MedException& ex) {
-    storeUpdateMutex.unlock();
-    cerr << ex.getMessage() << endl;
-  }
-  storeUpdateMutex.unlock();
+void MedUi::onScanTreeViewScrolled() {
+  updateRefreshRows(scanTreeView, scanModel);
+}
+
+void MedUi::onStoreTreeViewScrolled() {
+  updateRefreshRows(storeTreeView, storeModel);
 }
 
 UiState MedUi::getScanState() {
@@ -836,10 +909,12 @@ UiState MedUi::getStoreState() {
 
 void MedUi::setScanState(UiState state) {
   scanState = state;
+  scanModel->setEditing(state == UiState::Editing);
 }
 
 void MedUi::setStoreState(UiState state) {
   storeState = state;
+  storeModel->setEditing(state == UiState::Editing);
 }
 
 void MedUi::onScopeStartEdited() {
@@ -852,6 +927,14 @@ void MedUi::onScopeStartEdited() {
   }
 }
 
+void MedUi::onRegionPolicyChanged(QString name) {
+  try {
+    med->setRegionPolicy(RegionPolicy::preset(name.toStdString()));
+  } catch(MedException &ex) {
+    cerr << "onRegionPolicyChanged: " << ex.what() << endl;
+  }
+}
+
 void MedUi::onScopeEndEdited() {
   string end = mainWindow->findChild<QLineEdit*>("scopeEnd")->text().toStdString();
   if (end.size() == 0) {
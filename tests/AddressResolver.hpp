@@ -0,0 +1,104 @@
+#include <string>
+#include <unistd.h> //readlink()
+#include <sys/mman.h> //mmap()
+#include <cxxtest/TestSuite.h>
+
+#include "mem/AddressResolver.hpp"
+#include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
+
+long resolverStaticValue = 1234; // Initialized, so it is file backed
+
+class TestAddressResolver : public CxxTest::TestSuite {
+public:
+  void testParse() {
+    auto expression = AddressExpression::parse("[[libtest.so+0x10]+0x8]-0x4");
+    TS_ASSERT_EQUALS(expression.module, "libtest.so");
+    TS_ASSERT_EQUALS(expression.base, 0x10);
+    TS_ASSERT_EQUALS(expression.offsets.size(), 2);
+    TS_ASSERT_EQUALS(expression.offsets[0], 0x8);
+    TS_ASSERT_EQUALS(expression.offsets[1], (Address)-4);
+    TS_ASSERT_EQUALS(expression.toString(), "[[libtest.so+0x10]+0x8]-0x4");
+
+    expression = AddressExpression::parse("0x7ffd1000");
+    TS_ASSERT(expression.isAbsolute());
+    TS_ASSERT_EQUALS(expression.base, 0x7ffd1000);
+
+    expression = AddressExpression::parse("libstdc++.so.6+0x20");
+    TS_ASSERT_EQUALS(expression.module, "libstdc++.so.6");
+    TS_ASSERT_EQUALS(expression.base, 0x20);
+
+    expression = AddressExpression::parse("[0x1000]");
+    TS_ASSERT_EQUALS(expression.offsets.size(), 1);
+    TS_ASSERT_EQUALS(expression.offsets[0], 0);
+
+    TS_ASSERT_THROWS(AddressExpression::parse("[[libtest.so+0x10]+0x8"), MedException);
+    TS_ASSERT_THROWS(AddressExpression::parse("[libtest.so]+x"), MedException);
+    TS_ASSERT_THROWS(AddressExpression::parse(""), MedException);
+    TS_ASSERT_THROWS_NOTHING(expression = AddressExpression::parse("0x10000000000000000"));
+    TS_ASSERT_EQUALS(expression.module, "0x10000000000000000"); // Not an address, so a module name
+    TS_ASSERT_THROWS(AddressExpression::parse("[0x1000]+0x10000000000000000"), MedException);
+  }
+
+  void testResolveChains() {
+    MemIO memio;
+    AddressResolver resolver(&memio);
+    long values[4] = {0, 0, 42, 0};
+    long* inner[2] = {NULL, &values[0]}; // [[outer]+0x8]+0x10 reaches values[2]
+    long** outer = inner;
+
+    char buffer[64];
+    sprintf(buffer, "[[0x%lx]+0x8]+0x10", (Address)&outer);
+    auto deep = AddressExpression::parse(buffer);
+    sprintf(buffer, "[0x%lx]+0x8", (Address)&outer);
+    auto shallow = AddressExpression::parse(buffer);
+    sprintf(buffer, "[0x%lx]+0x8", (Address)&inner[0]); // Null pointer
+    auto broken = AddressExpression::parse(buffer);
+
+    auto addresses = resolver.resolve({ deep, shallow, broken });
+    TS_ASSERT_EQUALS(addresses[0], (Address)&values[2]);
+    TS_ASSERT_EQUALS(addresses[1], (Address)&inner[1]);
+    TS_ASSERT_EQUALS(addresses[2], 0);
+    TS_ASSERT_EQUALS(resolver.getBatchCount(), 2); // One read per level, not per entry
+  }
+
+  void testResolvePointer32() {
+    // 32-bit target pointers are only valid below 4GB
+    auto page = (uint32_t*)mmap(NULL, 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    TS_ASSERT(page != MAP_FAILED);
+    page[0] = (uint32_t)(Address)&page[8]; // Pointer to page[8]
+    page[1] = 0xdeadbeef; // Must not become the high half
+
+    MemIO memio;
+    AddressResolver resolver(&memio);
+    TS_ASSERT_EQUALS(resolver.getPointerSize(), (int)sizeof(Address)); // This test itself is 64-bit
+    resolver.setPointerSize(4);
+    TS_ASSERT_EQUALS(resolver.getPointerSize(), 4);
+
+    AddressExpression expression = AddressExpression::parse("[" + intToHex((Address)page) + "]+0x4");
+    TS_ASSERT_EQUALS(resolver.resolve(expression), (Address)&page[9]);
+    TS_ASSERT_THROWS(resolver.setPointerSize(2), MedException);
+    munmap(page, 4096);
+  }
+
+  void testResolveModule() {
+    char path[4096] = {0};
+    readlink("/proc/self/exe", path, sizeof(path) - 1);
+    string module = string(path).substr(string(path).rfind('/') + 1);
+    Address base = getAllMaps(0).getModuleBase(module);
+    TS_ASSERT(base);
+
+    MemIO memio;
+    AddressResolver resolver(&memio);
+    AddressExpression expression;
+    expression.module = module;
+    expression.base = (Address)&resolverStaticValue - base;
+    TS_ASSERT_EQUALS(resolver.resolve(expression), (Address)&resolverStaticValue);
+    unsigned long generation = resolver.getGeneration();
+    TS_ASSERT_EQUALS(resolver.resolve(expression), (Address)&resolverStaticValue);
+    TS_ASSERT_EQUALS(resolver.getGeneration(), generation); // Maps are not re-read within the interval
+
+    expression.module = "not-loaded.so";
+    TS_ASSERT_EQUALS(resolver.resolve(expression), 0);
+  }
+};
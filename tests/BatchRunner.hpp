@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <signal.h> //kill()
+#include <unistd.h> //fork()
+#include <sys/wait.h> //waitpid()
+#include <cxxtest/TestSuite.h>
+
+#include "cli/BatchRunner.hpp"
+#include "med/MedCommon.hpp"
+
+// More values than one chunk of "list", in whole pages for the scope
+const int BATCH_TARGET_SIZE = 5 * 1024;
+const int BATCH_TARGET_COUNT = BATCH_LIST_CHUNK + 904;
+alignas(4096) static int batchTarget[BATCH_TARGET_SIZE];
+
+class TestBatchRunner : public CxxTest::TestSuite {
+public:
+  pid_t pid;
+
+  void setUp() {
+    for (int i = 0; i < BATCH_TARGET_COUNT; i++) {
+      batchTarget[i] = 1513889584; // 0x5a3c1f30
+    }
+    pid = fork();
+    if (pid == 0) {
+      for (;;) pause(); // Target, same memory as this process
+    }
+  }
+
+  void tearDown() {
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+  }
+
+  // Runs the script and returns the output lines
+  vector<string> run(const string& script, BatchFormat format, int* status) {
+    MemEd memed(pid);
+    FILE* output = tmpfile();
+    BatchRunner runner(&memed, output, format);
+    istringstream input(script);
+    *status = runner.run(input);
+
+    vector<string> lines;
+    char buffer[4096];
+    rewind(output);
+    while (fgets(buffer, sizeof(buffer), output)) {
+      buffer[strcspn(buffer, "\n")] = '\0';
+      lines.push_back(buffer);
+    }
+    fclose(output);
+    return lines;
+  }
+
+  string scopeCommand() {
+    return "scope " + intToHex((Address)batchTarget) + " " + intToHex((Address)(batchTarget + BATCH_TARGET_SIZE)) + "\n";
+  }
+
+  void testJsonLines() {
+    int status;
+    auto lines = run("# comment\n" + scopeCommand() +
+                     "scan int32 1513889584\n"
+                     "\n"
+                     "count\n"
+                     "list 2\n", BatchFormat::JsonLines, &status);
+    TS_ASSERT_EQUALS(status, 0);
+    TS_ASSERT_EQUALS(lines.size(), 6);
+    TS_ASSERT_EQUALS(lines[0].find("{\"event\":\"command\",\"line\":2,\"command\":\"scope\""), 0);
+    TS_ASSERT_EQUALS(lines[1].find("{\"event\":\"command\",\"line\":3,\"command\":\"scan\",\"args\":\"int32 1513889584\",\"count\":" +
+                                   to_string(BATCH_TARGET_COUNT) + ","), 0);
+    TS_ASSERT_EQUALS(lines[2].find("{\"event\":\"command\",\"line\":5,\"command\":\"count\",\"args\":\"\",\"count\":" +
+                                   to_string(BATCH_TARGET_COUNT) + ","), 0);
+    TS_ASSERT_EQUALS(lines[3], "{\"event\":\"result\",\"address\":\"" + intToHex((Address)batchTarget) +
+                     "\",\"value\":\"1513889584\",\"type\":\"int32\"}");
+    TS_ASSERT_EQUALS(lines[4], "{\"event\":\"result\",\"address\":\"" + intToHex((Address)(batchTarget + 1)) +
+                     "\",\"value\":\"1513889584\",\"type\":\"int32\"}");
+    TS_ASSERT_EQUALS(lines[5].find("{\"event\":\"command\",\"line\":6,\"command\":\"list\",\"args\":\"2\",\"count\":2,"), 0);
+  }
+
+  void testListChunks() {
+    int status;
+    auto lines = run(scopeCommand() + "scan int32 1513889584\nlist\n", BatchFormat::JsonLines, &status);
+    TS_ASSERT_EQUALS(status, 0);
+    TS_ASSERT_EQUALS(lines.size(), BATCH_TARGET_COUNT + 3);
+
+    // Every row once, in order, across the chunk boundary
+    bool ordered = true;
+    for (int i = 0; i < BATCH_TARGET_COUNT; i++) {
+      string expected = "{\"event\":\"result\",\"address\":\"" + intToHex((Address)(batchTarget + i)) +
+        "\",\"value\":\"1513889584\",\"type\":\"int32\"}";
+      ordered = ordered && lines[i + 2] == expected;
+    }
+    TS_ASSERT(ordered);
+    TS_ASSERT_EQUALS(lines.back().find("{\"event\":\"command\",\"line\":3,\"command\":\"list\",\"args\":\"\",\"count\":" +
+                                       to_string(BATCH_TARGET_COUNT) + ","), 0);
+  }
+
+  void testCsv() {
+    int status;
+    auto lines = run(scopeCommand() + "scan int32 1513889584\nlist 1\n", BatchFormat::Csv, &status);
+    TS_ASSERT_EQUALS(status, 0);
+    TS_ASSERT_EQUALS(lines.size(), 5);
+    TS_ASSERT_EQUALS(lines[0], "event,line,command,args,count,ms,address,value,type,message");
+    TS_ASSERT_EQUALS(lines[2].find("command,2,scan,int32 1513889584," + to_string(BATCH_TARGET_COUNT) + ","), 0);
+    TS_ASSERT_EQUALS(lines[3], "result,3,,,,,"  + intToHex((Address)batchTarget) + ",1513889584,int32,");
+    TS_ASSERT_EQUALS(lines[4].find("command,3,list,1,1,"), 0);
+  }
+
+  void testError() {
+    int status;
+    auto lines = run("count\nbogus a,\"b\ncount\n", BatchFormat::Csv, &status);
+    TS_ASSERT_EQUALS(status, 1);
+    TS_ASSERT_EQUALS(lines.size(), 3); // Stops at the failed command
+    TS_ASSERT_EQUALS(lines[2], "error,2,bogus,\"a,\"\"b\",,,,,,Unknown command: bogus");
+
+    lines = run("list x\n", BatchFormat::JsonLines, &status); // Invalid number
+    TS_ASSERT_EQUALS(status, 1);
+    TS_ASSERT_EQUALS(lines.size(), 1);
+    TS_ASSERT_EQUALS(lines[0].find("{\"event\":\"error\",\"line\":1,\"command\":\"list\",\"args\":\"x\",\"message\":"), 0);
+
+    lines = run("scan int99 1\n", BatchFormat::JsonLines, &status);
+    TS_ASSERT_EQUALS(status, 1);
+    TS_ASSERT_EQUALS(lines[0], "{\"event\":\"error\",\"line\":1,\"command\":\"scan\",\"args\":\"int99 1\",\"message\":\"Unknown scan type: int99\"}");
+  }
+};
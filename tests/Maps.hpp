@@ -0,0 +1,125 @@
+#include <string>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/Maps.hpp"
+#include "mem/RegionPolicy.hpp"
+#include "med/MedException.hpp"
+
+const string SAMPLE_MAPS =
+  "55d0c4a00000-55d0c4a02000 r--p 00000000 fd:01 1048602                    /usr/bin/game\n"
+  "55d0c4a02000-55d0c4a08000 r-xp 00002000 fd:01 1048602                    /usr/bin/game\n"
+  "55d0c4c08000-55d0c4c09000 rw-p 00008000 fd:01 1048602                    /usr/bin/game\n"
+  "55d0c5b3e000-55d0c5b5f000 rw-p 00000000 00:00 0                          [heap]\n"
+  "7f1c2a000000-7f1c2a021000 rw-p 00000000 00:00 0 \n"
+  "7f1c2b400000-7f1c2b600000 rw-s 00000000 00:05 32789                      /dev/shm/my shared\n";
+
+class TestMaps : public CxxTest::TestSuite {
+public:
+  void testParse() {
+    Maps maps = Maps::parse(SAMPLE_MAPS);
+    TS_ASSERT_EQUALS(maps.size(), 6);
+
+    auto& regions = maps.getRegions();
+    TS_ASSERT_EQUALS(regions[1].start, 0x55d0c4a02000);
+    TS_ASSERT_EQUALS(regions[1].end, 0x55d0c4a08000);
+    TS_ASSERT(regions[1].executable);
+    TS_ASSERT(!regions[1].writable);
+    TS_ASSERT_EQUALS(regions[1].offset, 0x2000);
+    TS_ASSERT_EQUALS(regions[1].inode, 1048602);
+    TS_ASSERT_EQUALS(regions[1].pathname, "/usr/bin/game");
+    TS_ASSERT_EQUALS(regions[1].getModuleName(), "game");
+
+    TS_ASSERT_EQUALS(regions[3].pathname, "[heap]");
+    TS_ASSERT(regions[4].isAnonymous());
+    TS_ASSERT(regions[5].shared);
+    TS_ASSERT_EQUALS(regions[5].pathname, "/dev/shm/my shared");
+
+    TS_ASSERT_EQUALS(maps.getMaps().size(), 6);
+    TS_ASSERT_EQUALS(std::get<0>(maps.getMaps()[3]), 0x55d0c5b3e000);
+  }
+
+  void testFindRegion() {
+    Maps maps = Maps::parse(SAMPLE_MAPS);
+    TS_ASSERT_EQUALS(maps.findRegion(0x55d0c4a02000), 1);
+    TS_ASSERT_EQUALS(maps.findRegion(0x55d0c4a07fff), 1);
+    TS_ASSERT_EQUALS(maps.findRegion(0x55d0c4a08000), -1);
+    TS_ASSERT_EQUALS(maps.findRegion(0x1000), -1);
+    TS_ASSERT_EQUALS(maps.getRegion(0x55d0c5b3e010)->pathname, "[heap]");
+
+    TS_ASSERT(maps.hasPair(AddressPair(0x55d0c5b3e000, 0x55d0c5b5f000)));
+    TS_ASSERT(!maps.hasPair(AddressPair(0x55d0c5b3e000, 0x55d0c5b4f000)));
+  }
+
+  void testPushSorted() {
+    Maps maps;
+    maps.push(AddressPair(0x3000, 0x4000));
+    maps.push(AddressPair(0x1000, 0x2000));
+    TS_ASSERT_EQUALS(maps.getRegions()[0].start, 0x1000);
+    TS_ASSERT_EQUALS(std::get<0>(maps.getMaps()[0]), 0x1000);
+    TS_ASSERT_EQUALS(maps.findRegion(0x3800), 1);
+  }
+
+  void testSelectModule() {
+    Maps maps = Maps::parse(SAMPLE_MAPS);
+    Maps game = maps.selectModule("game");
+    TS_ASSERT_EQUALS(game.size(), 3);
+    TS_ASSERT_EQUALS(maps.selectModule("/usr/bin/game").size(), 3);
+    TS_ASSERT_EQUALS(maps.getModuleBase("game"), 0x55d0c4a00000);
+    TS_ASSERT_EQUALS(maps.getModuleBase("other"), 0);
+  }
+
+  void testRegionPolicy() {
+    Maps maps = Maps::parse(SAMPLE_MAPS);
+    TS_ASSERT_EQUALS(RegionPolicy::preset("all").select(maps).size(), 6);
+
+    Maps anonymous = RegionPolicy::preset("anonymous").select(maps);
+    TS_ASSERT_EQUALS(anonymous.size(), 2);
+    TS_ASSERT_EQUALS(anonymous.getRegions()[0].pathname, "[heap]");
+    TS_ASSERT(anonymous.getRegions()[1].isAnonymous());
+
+    TS_ASSERT_EQUALS(RegionPolicy::preset("heap").select(maps).size(), 1);
+    TS_ASSERT_EQUALS(RegionPolicy::preset("private").select(maps).size(), 5);
+
+    RegionPolicy policy;
+    policy.includes = { "/usr/bin/*" };
+    policy.minSize = 0x2000;
+    TS_ASSERT_EQUALS(policy.select(maps).size(), 2);
+
+    policy = RegionPolicy();
+    policy.excludes = { "*game", "/dev/shm/*" };
+    policy.maxSize = 0x21000;
+    TS_ASSERT_EQUALS(policy.select(maps).size(), 2);
+
+    TS_ASSERT_THROWS(RegionPolicy::preset("unknown"), MedException);
+
+    policy = RegionPolicy::parse({ "private", "+/usr/bin/*", "min=0x2000" });
+    TS_ASSERT(policy.skipShared);
+    TS_ASSERT_EQUALS(policy.select(maps).size(), 2);
+    TS_ASSERT_THROWS(RegionPolicy::parse({ "all", "size=1" }), MedException);
+    TS_ASSERT_THROWS(RegionPolicy::parse({ "all", "min=x" }), MedException);
+    TS_ASSERT_THROWS(RegionPolicy::parse({ "all", "max=0x1000k" }), MedException);
+    TS_ASSERT_THROWS(RegionPolicy::parse({ "all", "max=0x100000000000000000" }), MedException);
+    TS_ASSERT_EQUALS(RegionPolicy::parse({ "all", "max=4096" }).maxSize, 4096);
+  }
+
+  void testSubtract() {
+    Maps before;
+    before.push(AddressPair(0x1000, 0x3000));
+    before.push(AddressPair(0x5000, 0x6000));
+
+    Maps after;
+    after.push(AddressPair(0x1000, 0x4000)); // Grown
+    after.push(AddressPair(0x8000, 0x9000)); // New, and 0x5000 is unmapped
+
+    Maps added = after.subtract(before);
+    TS_ASSERT_EQUALS(added.size(), 2);
+    TS_ASSERT(added.hasPair(AddressPair(0x3000, 0x4000)));
+    TS_ASSERT(added.hasPair(AddressPair(0x8000, 0x9000)));
+
+    Maps removed = before.subtract(after);
+    TS_ASSERT_EQUALS(removed.size(), 1);
+    TS_ASSERT(removed.hasPair(AddressPair(0x5000, 0x6000)));
+
+    TS_ASSERT_EQUALS(after.subtract(after).size(), 0);
+  }
+};
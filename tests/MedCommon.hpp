@@ -2,6 +2,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include "med/MedCommon.hpp"
+#include "med/MedException.hpp"
 
 class TestMedCommon : public CxxTest::TestSuite {
 public:
@@ -11,6 +12,14 @@ public:
     TS_ASSERT_EQUALS(res, 10);
   }
 
+  void testHexToInt() {
+    TS_ASSERT_EQUALS(hexToInt("7ffd1000"), 0x7ffd1000);
+    TS_ASSERT_EQUALS(hexToInt("0x1A"), 0x1a);
+    TS_ASSERT_EQUALS(hexToInt(" ff"), 0xff);
+    TS_ASSERT_THROWS(hexToInt("xyz"), MedException);
+    TS_ASSERT_THROWS(hexToInt(""), MedException);
+  }
+
   void testGetPidStatus() {
     char pid[] = "351443 (Puzzle Quest.ex) T 351403 351365";
     char res = getPidStatus(pid);
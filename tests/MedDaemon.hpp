@@ -0,0 +1,75 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <signal.h> //kill()
+#include <unistd.h> //fork()
+#include <sys/wait.h> //waitpid()
+#include <cxxtest/TestSuite.h>
+
+#include "mem/DaemonClient.hpp"
+#include "mem/MedDaemon.hpp"
+#include "med/MedException.hpp"
+
+volatile int daemonTarget = 0x5a3c1f2e; // Unlikely to be anywhere else, same address in the child
+
+class TestMedDaemon : public CxxTest::TestSuite {
+public:
+  void testSession() {
+    string path = "/tmp/med-test-" + to_string(getpid()) + ".sock";
+    MedDaemon daemon(path);
+    daemon.start();
+    std::thread server(&MedDaemon::run, &daemon);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      for (;;) pause(); // Target
+    }
+
+    {
+      DaemonClient client(path);
+      Address address = (Address)&daemonTarget;
+      auto readTarget = [&]() {
+        return *(const int*)client.read(pid, address, sizeof(int)).data();
+      };
+
+      auto results = client.scan(pid, "1513889582", "int32"); // 0x5a3c1f2e
+      bool found = false;
+      for (size_t i = 0; i < results.size(); i++) {
+        found = found || results[i].address == address;
+      }
+      TS_ASSERT(found);
+
+      // Another frontend shares the same warm session
+      DaemonClient other(path);
+      TS_ASSERT_EQUALS(other.getResults(pid).size(), results.size());
+      TS_ASSERT_EQUALS(daemon.getSessionCount(), 1);
+
+      int value = 7;
+      client.write(pid, address, string((const char*)&value, sizeof(value)));
+      TS_ASSERT_EQUALS(readTarget(), 7);
+
+      client.freeze(pid, address, "99", "int32");
+      value = 1;
+      client.write(pid, address, string((const char*)&value, sizeof(value)));
+      std::this_thread::sleep_for(std::chrono::milliseconds(FREEZE_INTERVAL * 5));
+      TS_ASSERT_EQUALS(readTarget(), 99);
+      TS_ASSERT(client.unfreeze(pid, address));
+      value = 2;
+      client.write(pid, address, string((const char*)&value, sizeof(value)));
+      std::this_thread::sleep_for(std::chrono::milliseconds(FREEZE_INTERVAL * 5));
+      TS_ASSERT_EQUALS(readTarget(), 2);
+
+      TS_ASSERT_THROWS(client.read(pid, 0, 4), MedException);
+      TS_ASSERT_THROWS(client.scan(pid, "1", "nothing"), MedException);
+
+      client.close(pid);
+      TS_ASSERT_EQUALS(daemon.getSessionCount(), 0);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+
+    daemon.stop();
+    server.join();
+    TS_ASSERT_THROWS(DaemonClient client(path), MedException);
+  }
+};
@@ -0,0 +1,108 @@
+#include <cstdio>
+#include <fstream>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/MemEd.hpp"
+#include "mem/Sem.hpp"
+#include "med/MedException.hpp"
+
+class TestMemEd : public CxxTest::TestSuite {
+public:
+  void testTableRoundTrip() {
+    int value = 123;
+    MemEd med;
+    med.addNewAddress();
+    med.addNewAddress();
+    auto first = static_pointer_cast<Sem>(med.getStore()->getList()[0]);
+    first->setAddress((Address)&value);
+    first->setDescription("health");
+    auto second = static_pointer_cast<Sem>(med.getStore()->getList()[1]);
+    second->setAddressExpression("[libtest.so+0x10]+0x8");
+    second->setScanType("int16");
+    med.setNotes("notes");
+
+    med.saveFile("/tmp/med-test.medtable");
+    MemEd loaded;
+    loaded.openFile("/tmp/med-test.medtable");
+    remove("/tmp/med-test.medtable");
+
+    auto& list = loaded.getStore()->getList();
+    TS_ASSERT_EQUALS(list.size(), 2);
+    auto sem = static_pointer_cast<Sem>(list[0]);
+    TS_ASSERT_EQUALS(sem->getAddress(), (Address)&value);
+    TS_ASSERT_EQUALS(sem->getDescription(), "health");
+    TS_ASSERT_EQUALS(sem->getScanType(), "int32");
+    TS_ASSERT(!sem->hasAddressExpression());
+    sem = static_pointer_cast<Sem>(list[1]);
+    TS_ASSERT_EQUALS(sem->getScanType(), "int16");
+    TS_ASSERT_EQUALS(sem->getSize(), 2);
+    TS_ASSERT_EQUALS(sem->getAddressExpression().toString(), "[libtest.so+0x10]+0x8");
+    TS_ASSERT_EQUALS(loaded.getNotes(), "notes");
+  }
+
+  void testCorruptTable() {
+    MemEd med;
+    med.addNewAddress();
+    static_pointer_cast<Sem>(med.getStore()->getList()[0])->setDescription("health");
+    med.setNotes("notes");
+    med.saveFile("/tmp/med-test.medtable");
+
+    FILE* file = fopen("/tmp/med-test.medtable", "rb");
+    vector<char> saved(4096);
+    saved.resize(fread(saved.data(), 1, saved.size(), file));
+    fclose(file);
+
+    auto loadPatched = [&](void (*patch)(char*)) {
+      vector<char> bytes = saved;
+      patch(bytes.data());
+      FILE* file = fopen("/tmp/med-test.medtable", "wb");
+      fwrite(bytes.data(), 1, bytes.size(), file);
+      fclose(file);
+      MemEd loaded;
+      TS_ASSERT_THROWS(loaded.openFile("/tmp/med-test.medtable"), MedException);
+      TS_ASSERT_EQUALS(loaded.getStore()->size(), 0);
+    };
+
+    // The entry count wraps the size around
+    loadPatched([](char* bytes) {
+      ((StoreTableHeader*)bytes)->entryCount = (uint64_t)-1 / sizeof(StoreTableEntry) + 2;
+    });
+    // The text size wraps the end of the text around
+    loadPatched([](char* bytes) {
+      ((StoreTableHeader*)bytes)->textSize = (uint64_t)-1;
+    });
+    loadPatched([](char* bytes) {
+      ((StoreTableHeader*)bytes)->notesOffset = (uint64_t)-2;
+    });
+    // Description far outside of the text
+    loadPatched([](char* bytes) {
+      auto header = (StoreTableHeader*)bytes;
+      ((StoreTableEntry*)(bytes + header->entriesOffset))->textOffset = (uint64_t)-4;
+    });
+    loadPatched([](char* bytes) {
+      ((StoreTableHeader*)bytes)->version = 0;
+    });
+    remove("/tmp/med-test.medtable");
+  }
+
+  void testJsonValues() {
+    int value = 123;
+    MemEd med;
+    med.addNewAddress();
+    med.getStore()->getList()[0]->setAddress((Address)&value);
+
+    med.saveFile("/tmp/med-test.json");
+    Json::Value root;
+    ifstream("/tmp/med-test.json") >> root;
+    TS_ASSERT(!root["addresses"][0].isMember("value")); // Not read unless asked
+
+    med.saveFile("/tmp/med-test.json", true);
+    ifstream("/tmp/med-test.json") >> root;
+    TS_ASSERT_EQUALS(root["addresses"][0]["value"].asString(), "123");
+
+    MemEd loaded;
+    loaded.openFile("/tmp/med-test.json");
+    remove("/tmp/med-test.json");
+    TS_ASSERT_EQUALS(loaded.getStore()->getList()[0]->getAddress(), (Address)&value);
+  }
+};
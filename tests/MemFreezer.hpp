@@ -0,0 +1,78 @@
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <chrono>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/MemFreezer.hpp"
+#include "med/ScanParser.hpp"
+
+class TestMemFreezer : public CxxTest::TestSuite {
+public:
+  void testTick() {
+    MemIO memio;
+    MemFreezer freezer(&memio);
+    int memory[] = {100, 200};
+
+    vector<FreezeEntry> entries = {
+      { (Address)&memory[0], ScanParser::valueToBytes("30", "int32") },
+      { (Address)&memory[1], ScanParser::valueToBytes("40", "int32") }
+    };
+    freezer.setEntries(entries);
+    freezer.tick();
+
+    TS_ASSERT_EQUALS(memory[0], 30);
+    TS_ASSERT_EQUALS(memory[1], 40);
+  }
+
+  void testRunning() {
+    MemIO memio;
+    MemScheduler scheduler(&memio);
+    MemFreezer freezer(&memio);
+    volatile int memory = 100;
+
+    freezer.setEntries({ { (Address)&memory, ScanParser::valueToBytes("30", "int32") } });
+    scheduler.subscribe(&freezer, 1, 1);
+    scheduler.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    memory = 10;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    scheduler.stop();
+
+    TS_ASSERT_EQUALS(memory, 30);
+  }
+
+  void testRevertCount() {
+    MemIO memio;
+    MemFreezer freezer(&memio);
+    int memory[] = {30, 200};
+
+    freezer.setEntries({
+        { (Address)&memory[0], ScanParser::valueToBytes("30", "int32") },
+        { (Address)&memory[1], ScanParser::valueToBytes("40", "int32") }
+      });
+    freezer.tick(); // The first write of a new lock is not a revert
+    TS_ASSERT_EQUALS(memory[1], 40);
+    TS_ASSERT_EQUALS(freezer.getRevertCount((Address)&memory[0]), 0);
+    TS_ASSERT_EQUALS(freezer.getRevertCount((Address)&memory[1]), 0);
+
+    memory[1] = 39;
+    freezer.tick();
+    freezer.tick();
+    TS_ASSERT_EQUALS(memory[1], 40);
+    TS_ASSERT_EQUALS(freezer.getRevertCount((Address)&memory[1]), 1);
+
+    // Same lock set again is not new
+    freezer.setEntries({ { (Address)&memory[1], ScanParser::valueToBytes("40", "int32") } });
+    TS_ASSERT_EQUALS(freezer.getRevertCount((Address)&memory[1]), 1);
+    memory[1] = 39;
+    freezer.tick();
+    TS_ASSERT_EQUALS(freezer.getRevertCount((Address)&memory[1]), 2);
+
+    // New locked value
+    freezer.setEntries({ { (Address)&memory[1], ScanParser::valueToBytes("50", "int32") } });
+    freezer.tick();
+    TS_ASSERT_EQUALS(memory[1], 50);
+    TS_ASSERT_EQUALS(freezer.getRevertCount((Address)&memory[1]), 2);
+  }
+};
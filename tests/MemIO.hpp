@@ -1,5 +1,9 @@
 #include <string>
 #include <cstdio>
+#include <thread>
+#include <chrono>
+#include <unistd.h> //getpid(), getpagesize()
+#include <sys/mman.h> //mmap()
 #include <cxxtest/TestSuite.h>
 
 #include "mem/MemIO.hpp"
@@ -28,4 +32,51 @@ public:
     TS_ASSERT_EQUALS(ptr1[1], 0x68);
     TS_ASSERT_EQUALS(ptr1[2], 0x66);
   }
+
+  void testBatch() {
+    int memory[] = { 10, 20, 30 };
+    int buffer[] = { 0, 0 };
+    MemIO memIO;
+    MemSegments reads = {
+      { (Address)&memory[0], (Byte*)&buffer[0], sizeof(int), false },
+      { (Address)&memory[2], (Byte*)&buffer[1], sizeof(int), false }
+    };
+    TS_ASSERT_EQUALS(memIO.readBatch(reads), 2);
+    TS_ASSERT_EQUALS(buffer[0], 10);
+    TS_ASSERT_EQUALS(buffer[1], 30);
+    TS_ASSERT(reads[1].ok);
+
+    int value = 99;
+    MemSegments writes = { { (Address)&memory[1], (Byte*)&value, sizeof(int), false } };
+    TS_ASSERT_EQUALS(memIO.writeBatch(writes), 1);
+    TS_ASSERT_EQUALS(memory[1], 99);
+  }
+
+  void testUnreadableCache() {
+    size_t pageSize = getpagesize();
+    Byte* pages = (Byte*)mmap(NULL, pageSize * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    pages[0] = 42;
+    munmap(pages + pageSize, pageSize);
+
+    MemIO memIO;
+    memIO.setPid(getpid()); // Through the syscalls, as the other process
+    Byte buffer[8];
+    TS_ASSERT(memIO.read((Address)pages, buffer, 1));
+    TS_ASSERT_EQUALS(buffer[0], 42);
+
+    TS_ASSERT(!memIO.read((Address)pages + pageSize - 4, buffer, 8)); // Crosses into the unmapped page
+    TS_ASSERT_EQUALS(memIO.getUnreadableCount(), 1); // Only the unmapped page
+    TS_ASSERT(memIO.read((Address)pages, buffer, 1));
+
+    TS_ASSERT(!memIO.read((Address)pages + pageSize, buffer, 4));
+    TS_ASSERT_EQUALS(memIO.getSkipCount(), 1);
+
+    // Mapped again, the cache is dropped with the maps change
+    mmap(pages + pageSize, pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(MAPS_CHECK_INTERVAL + 10));
+    TS_ASSERT(memIO.read((Address)pages + pageSize, buffer, 4));
+    TS_ASSERT_EQUALS(memIO.getUnreadableCount(), 0);
+
+    munmap(pages, pageSize * 2);
+  }
 };
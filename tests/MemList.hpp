@@ -0,0 +1,87 @@
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/MemList.hpp"
+#include "mem/Pem.hpp"
+
+class TestMemList : public CxxTest::TestSuite {
+public:
+  void testCopyIsStableSnapshot() {
+    MemIO memio;
+    int memory[] = {1, 2};
+    vector<MemPtr> first = {
+      PemPtr(new Pem((Address)&memory[0], 4, &memio)),
+      PemPtr(new Pem((Address)&memory[1], 4, &memio))
+    };
+    MemList list(first);
+    MemList snapshot = list;
+
+    list.setList(vector<MemPtr>{ first[1] });
+    TS_ASSERT_EQUALS(list.size(), 1);
+    TS_ASSERT_EQUALS(snapshot.size(), 2);
+    TS_ASSERT_EQUALS(snapshot.getAddress(0), (Address)&memory[0]);
+
+    list.clear();
+    TS_ASSERT_EQUALS(list.size(), 0);
+    TS_ASSERT_EQUALS(snapshot.size(), 2);
+  }
+
+  void testChangesDoNotTouchCopies() {
+    MemIO memio;
+    int memory[] = {1, 2};
+    MemList list(vector<MemPtr>{
+      PemPtr(new Pem((Address)&memory[1], 4, &memio)),
+      PemPtr(new Pem((Address)&memory[0], 4, &memio))
+    });
+    MemList snapshot = list;
+
+    list.sortByAddress();
+    TS_ASSERT_EQUALS(list.getAddress(0), (Address)&memory[0]);
+    TS_ASSERT_EQUALS(snapshot.getAddress(0), (Address)&memory[1]);
+
+    list.addMemPtr(PemPtr(new Pem((Address)&memory[0], 4, &memio)));
+    list.deleteAddress(0);
+    TS_ASSERT_EQUALS(list.size(), 2);
+    TS_ASSERT_EQUALS(snapshot.size(), 2);
+    TS_ASSERT_EQUALS(snapshot.getAddress(1), (Address)&memory[0]);
+  }
+
+  void testGetValues() {
+    MemIO memio;
+    int memory[] = {10, 20, 30};
+    vector<MemPtr> mems;
+    for (int i = 0; i < 3; i++) {
+      PemPtr pem = PemPtr(new Pem((Address)&memory[i], 4, &memio));
+      pem->setScanType("int32");
+      mems.push_back(pem);
+    }
+    MemList list(mems);
+
+    auto values = list.getValues(1, 5);
+    TS_ASSERT_EQUALS(values.size(), 2);
+    TS_ASSERT_EQUALS(values[0], "20");
+    TS_ASSERT_EQUALS(values[1], "30");
+  }
+
+  void testGetStringValues() {
+    MemIO memio;
+    static char memory[2 * MAX_STRING_SIZE] = "first match";
+    strcpy(memory + MAX_STRING_SIZE, "second");
+    vector<MemPtr> mems;
+    for (auto addr : { (Address)memory, (Address)memory + MAX_STRING_SIZE }) {
+      PemPtr pem = PemPtr(new Pem(addr, 3, &memio)); // Only the matched length is kept
+      pem->setScanType("string");
+      mems.push_back(pem);
+    }
+    MemList list(mems);
+
+    auto ranges = list.getRanges(0, 1);
+    TS_ASSERT_EQUALS(ranges[0].size, (size_t)MAX_STRING_SIZE - 1);
+    auto values = list.getValues(0, 1);
+    TS_ASSERT_EQUALS(values.size(), 2);
+    TS_ASSERT_EQUALS(values[0], "first match");
+    TS_ASSERT_EQUALS(values[1], "second");
+  }
+};
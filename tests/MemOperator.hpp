@@ -81,12 +81,12 @@ public:
   void test_compare_operands() {
     int length = 4;
     SizedBytes sizedBytes = SizedBytes::create(length);
-    Operands operands(std::vector<SizedBytes>{ sizedBytes });
     Byte* ptr = sizedBytes.getBytes();
     ptr[0] = 1;
     ptr[1] = 0;
     ptr[2] = 0;
     ptr[3] = 0;
+    Operands operands(std::vector<SizedBytes>{ sizedBytes }); // Copied, small values are not shared
 
     Byte* bytes = new Byte[length];
     ptr = bytes;
@@ -1,6 +1,9 @@
 #include <string>
 #include <cstdio>
 #include <iostream>
+#include <signal.h>
+#include <unistd.h> //fork()
+#include <sys/wait.h>
 #include <cxxtest/TestSuite.h>
 
 #include "mem/MemScanner.hpp"
@@ -8,6 +11,8 @@
 
 using namespace std;
 
+alignas(4096) static int statsTarget[1024]; // One page, in the scope of the scan
+
 class TestMemScanner : public CxxTest::TestSuite {
 public:
   void testScan() {
@@ -118,4 +123,54 @@ public:
     TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)memory + 1);
     TS_ASSERT_EQUALS(list[3]->getAddress(), (Address)memory + 4);
   }
+
+  void testDropUnmapped() {
+    Maps maps;
+    maps.push(AddressPair(0x1000, 0x2000));
+
+    vector<MemPtr> list;
+    for (Address address : { 0x1000, 0x1ffe, 0x3000 }) { // 0x1ffe crosses the end
+      MemPtr mem = MemPtr(new Mem(4));
+      mem->setAddress(address);
+      list.push_back(mem);
+    }
+    auto kept = MemScanner::dropUnmapped(list, maps);
+    TS_ASSERT_EQUALS(kept.size(), 1);
+    TS_ASSERT_EQUALS(kept[0]->getAddress(), 0x1000);
+  }
+
+  void testStats() {
+    statsTarget[5] = 1513889583;
+    pid_t pid = fork();
+    if (pid == 0) {
+      for (;;) pause(); // Target
+    }
+
+    MemScanner scanner(pid);
+    scanner.setScopeStart((Address)statsTarget);
+    scanner.setScopeEnd((Address)statsTarget + sizeof(statsTarget));
+    auto buffer = ScanParser::valueToBytes("1513889583", "int32");
+    Operands operands(std::vector<SizedBytes>{ buffer });
+
+    auto list = scanner.scan(operands, buffer.getSize(), "int32", ScanParser::OpType::Eq);
+    ScanStats stats = scanner.getLastStats();
+    TS_ASSERT_EQUALS(list.size(), 1);
+    TS_ASSERT_EQUALS(stats.operation, "scan");
+    TS_ASSERT_EQUALS(stats.matches, 1);
+    TS_ASSERT_EQUALS(stats.bytesRead, sizeof(statsTarget));
+    TS_ASSERT_EQUALS(stats.pagesRead, 1);
+    TS_ASSERT(stats.syscalls > 0);
+
+    list = scanner.filter(list, operands, buffer.getSize(), "int32", ScanParser::OpType::Eq);
+    stats = scanner.getLastStats();
+    TS_ASSERT_EQUALS(stats.operation, "filter");
+    TS_ASSERT_EQUALS(stats.matches, 1);
+    TS_ASSERT_EQUALS(stats.bytesRequested, sizeof(int));
+    TS_ASSERT_EQUALS(stats.readErrors, 0);
+    TS_ASSERT(stats.workerBusyMs.size() > 0);
+    TS_ASSERT_EQUALS(stats.workerBusyMs.size(), stats.workerIdleMs.size());
+
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+  }
 };
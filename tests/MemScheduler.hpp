@@ -0,0 +1,100 @@
+#include <string>
+#include <vector>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/MemScheduler.hpp"
+
+// Reads the given ranges, and keeps the values of the last delivery
+class RangeSubscriber : public MemSubscriber {
+public:
+  vector<MemRange> ranges;
+  vector<int> values;
+  bool changed = false;
+
+  void collect(vector<MemRange>& reads) {
+    reads.insert(reads.end(), ranges.begin(), ranges.end());
+  }
+
+  bool deliver(const MemSegments& results, MemSegments& writes) {
+    values.clear();
+    for (auto& result : results) {
+      values.push_back(result.ok ? *(int*)result.buffer : -1);
+    }
+    return changed;
+  }
+};
+
+class TestMemScheduler : public CxxTest::TestSuite {
+public:
+  void testCoalesce() {
+    MemIO memio;
+    MemScheduler scheduler(&memio);
+    int memory[] = {10, 20, 30};
+
+    RangeSubscriber first, second;
+    first.ranges = { { (Address)&memory[2], sizeof(int) }, { (Address)&memory[0], sizeof(int) } };
+    second.ranges = { { (Address)&memory[1], sizeof(int) } };
+    scheduler.subscribe(&first, 10, 10);
+    scheduler.subscribe(&second, 10, 10);
+    scheduler.tick();
+
+    TS_ASSERT_EQUALS(scheduler.getSpanCount(), 1);
+    TS_ASSERT_EQUALS(first.values.size(), 2);
+    TS_ASSERT_EQUALS(first.values[0], 30);
+    TS_ASSERT_EQUALS(first.values[1], 10);
+    TS_ASSERT_EQUALS(second.values[0], 20);
+  }
+
+  void testDue() {
+    MemIO memio;
+    MemScheduler scheduler(&memio);
+    int memory = 10;
+
+    RangeSubscriber subscriber;
+    subscriber.ranges = { { (Address)&memory, sizeof(int) } };
+    scheduler.subscribe(&subscriber, 1000, 1000);
+    scheduler.tick();
+    TS_ASSERT_EQUALS(subscriber.values.size(), 1);
+
+    subscriber.values.clear();
+    scheduler.tick(); // Not due yet
+    TS_ASSERT_EQUALS(subscriber.values.size(), 0);
+
+    scheduler.wake(&subscriber);
+    scheduler.tick();
+    TS_ASSERT_EQUALS(subscriber.values.size(), 1);
+  }
+
+  void testAdaptiveInterval() {
+    MemIO memio;
+    MemScheduler scheduler(&memio);
+    int memory = 10;
+
+    RangeSubscriber subscriber;
+    subscriber.ranges = { { (Address)&memory, sizeof(int) } };
+    scheduler.subscribe(&subscriber, 10, 30);
+    TS_ASSERT_EQUALS(scheduler.getInterval(&subscriber), 10);
+
+    scheduler.tick();
+    TS_ASSERT_EQUALS(scheduler.getInterval(&subscriber), 20);
+    scheduler.wake(&subscriber);
+    scheduler.tick();
+    TS_ASSERT_EQUALS(scheduler.getInterval(&subscriber), 30);
+
+    subscriber.changed = true;
+    scheduler.wake(&subscriber);
+    scheduler.tick();
+    TS_ASSERT_EQUALS(scheduler.getInterval(&subscriber), 10);
+  }
+
+  void testMinInterval() {
+    MemIO memio;
+    MemScheduler scheduler(&memio);
+    RangeSubscriber subscriber;
+    scheduler.subscribe(&subscriber, 0, 0);
+    TS_ASSERT_EQUALS(scheduler.getInterval(&subscriber), MIN_SCHEDULE_INTERVAL);
+
+    scheduler.unsubscribe(&subscriber);
+    TS_ASSERT_EQUALS(scheduler.getInterval(&subscriber), -1);
+  }
+};
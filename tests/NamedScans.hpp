@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <cstring>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/NamedScans.hpp"
+#include "mem/Pem.hpp"
+#include "med/MedException.hpp"
+
+class TestNamedScans : public CxxTest::TestSuite {
+public:
+  void testSessionRoundTrip() {
+    MemIO memio;
+    int value = 100;
+    int remembered = 42;
+    NamedScans scans;
+
+    PemPtr pem = PemPtr(new Pem((Address)&value, 4, &memio));
+    pem->setScanType("int32");
+    pem->rememberValue((Byte*)&remembered, sizeof(remembered));
+    scans.setMemPtrs({ pem }, "int32");
+
+    scans.addNewScan("health");
+    scans.setActiveName("health");
+    PemPtr other = PemPtr(new Pem((Address)0x1000, 2, &memio)); // Not readable, must not be read on load
+    other->setScanType("int16");
+    scans.setMemPtrs({ other, other }, "int16");
+
+    MemPtr block = MemPtr(new Mem(8));
+    memcpy(block->getData(), "snapshot", 8);
+    block->setAddress(0x2000);
+    scans.save("/tmp/med-test.medscans", { block });
+
+    value = 200; // Remembered value comes from the file
+    NamedScans loaded;
+    vector<MemPtr> snapshot;
+    loaded.load("/tmp/med-test.medscans", &memio, &snapshot);
+    remove("/tmp/med-test.medscans");
+
+    TS_ASSERT_EQUALS(loaded.getNames().size(), 2);
+    TS_ASSERT_EQUALS(loaded.getActiveName(), "health");
+    TS_ASSERT_EQUALS(loaded.getScanType(), "int16");
+    TS_ASSERT_EQUALS(loaded.getMemList()->size(), 2);
+    TS_ASSERT_EQUALS(loaded.getMemList()->getList()[0]->getAddress(), 0x1000);
+
+    loaded.setActiveName(NamedScans::DEFAULT);
+    TS_ASSERT_EQUALS(loaded.getScanType(), "int32");
+    auto restored = static_pointer_cast<Pem>(loaded.getMemList()->getList()[0]);
+    TS_ASSERT_EQUALS(restored->getAddress(), (Address)&value);
+    TS_ASSERT_EQUALS(restored->getScanType(), "int32");
+    TS_ASSERT_EQUALS(restored->recallValue("int32"), "42");
+    TS_ASSERT_EQUALS(restored->getValue(), "200");
+
+    TS_ASSERT_EQUALS(snapshot.size(), 1);
+    TS_ASSERT_EQUALS(snapshot[0]->getAddress(), 0x2000);
+    TS_ASSERT_EQUALS(memcmp(snapshot[0]->getData(), "snapshot", 8), 0);
+  }
+
+  void testInvalidSession() {
+    FILE* file = fopen("/tmp/med-test.medscans", "wb");
+    fputs("not a session file, but long enough for the header size...........", file);
+    fclose(file);
+
+    NamedScans scans;
+    TS_ASSERT_THROWS(scans.load("/tmp/med-test.medscans", NULL), MedException);
+    remove("/tmp/med-test.medscans");
+    TS_ASSERT_THROWS(scans.load("/tmp/med-test.medscans", NULL), MedException);
+    TS_ASSERT_EQUALS(scans.getActiveName(), NamedScans::DEFAULT);
+  }
+
+  void testCorruptSession() {
+    MemIO memio;
+    NamedScans scans;
+    PemPtr pem = PemPtr(new Pem((Address)0x1000, 4, &memio));
+    pem->setScanType("int32");
+    scans.setMemPtrs({ pem }, "int32");
+    scans.save("/tmp/med-test.medscans");
+
+    FILE* file = fopen("/tmp/med-test.medscans", "rb");
+    vector<char> saved(4096);
+    saved.resize(fread(saved.data(), 1, saved.size(), file));
+    fclose(file);
+
+    auto loadPatched = [&](void (*patch)(char*)) {
+      vector<char> bytes = saved;
+      patch(bytes.data());
+      FILE* file = fopen("/tmp/med-test.medscans", "wb");
+      fwrite(bytes.data(), 1, bytes.size(), file);
+      fclose(file);
+      NamedScans loaded;
+      TS_ASSERT_THROWS(loaded.load("/tmp/med-test.medscans", &memio), MedException);
+    };
+
+    // Too many scans, the size would wrap around
+    loadPatched([](char* bytes) {
+      ((ScanSessionHeader*)bytes)->scanCount = 0xffffffff;
+    });
+    // Offsets that only fit after the sum overflows
+    loadPatched([](char* bytes) {
+      ((ScanSessionHeader*)bytes)->valuesSize = (uint64_t)-1;
+    });
+    // Result larger than any scan type
+    loadPatched([](char* bytes) {
+      auto header = (ScanSessionHeader*)bytes;
+      ((ScanSessionEntry*)(bytes + header->entriesOffset))->size = 0x7fffffff;
+    });
+    // Entry range that wraps around
+    loadPatched([](char* bytes) {
+      auto header = (ScanSessionHeader*)bytes;
+      ((ScanSessionScan*)(bytes + header->scansOffset))->entryCount = (uint64_t)-1;
+    });
+    remove("/tmp/med-test.medscans");
+  }
+};
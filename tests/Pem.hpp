@@ -42,4 +42,52 @@ public:
     TS_ASSERT_EQUALS(value, "20");
     delete memio;
   }
+
+  void testSetScanType() {
+    MemIO* memio = new MemIO();
+    int memory = 100;
+    PemPtr pem = PemPtr(new Pem((Address)&memory, 4, memio));
+    Byte* inlineData = pem->getData();
+
+    pem->setScanType("int32"); // Same size, kept
+    TS_ASSERT_EQUALS(pem->getData(), inlineData);
+    TS_ASSERT_EQUALS(pem->getAddress(), (Address)&memory);
+
+    pem->setScanType("string"); // Keeps the matched length
+    TS_ASSERT_EQUALS(pem->getSize(), 4);
+    TS_ASSERT_EQUALS(pem->getData(), inlineData);
+
+    pem->setScanType("float64");
+    TS_ASSERT_EQUALS(pem->getSize(), 8);
+    TS_ASSERT_EQUALS(pem->getData(), inlineData);
+    TS_ASSERT_EQUALS(pem->getAddress(), (Address)&memory);
+    delete memio;
+  }
+
+  void testStringPreview() {
+    MemIO* memio = new MemIO();
+    static char memory[MAX_STRING_SIZE] = "hello world";
+    PemPtr pem = PemPtr(new Pem((Address)memory, 5, memio));
+    pem->setScanType("string");
+
+    TS_ASSERT_EQUALS(pem->getSize(), 5);
+    TS_ASSERT_EQUALS(pem->getPreviewSize(), (size_t)MAX_STRING_SIZE - 1);
+    TS_ASSERT_EQUALS(pem->getPreviewSize("int32"), 5);
+    TS_ASSERT_EQUALS(pem->getValue(), "hello world");
+    delete memio;
+  }
+
+  void testRememberingLongValue() {
+    MemIO* memio = new MemIO();
+    int memory = 100;
+    PemPtr pem = PemPtr(new Pem((Address)&memory, 4, memio));
+    pem->rememberValue("a string longer than inline", "string");
+    TS_ASSERT_EQUALS(pem->recallValueSize(), 27);
+    TS_ASSERT_EQUALS(string((char*)pem->recallValuePtr(), pem->recallValueSize()), "a string longer than inline");
+
+    pem->rememberValue("1,2,3", "int32");
+    TS_ASSERT_EQUALS(pem->recallValueSize(), 12);
+    TS_ASSERT_EQUALS(pem->recallValue("int32"), "1");
+    delete memio;
+  }
 };
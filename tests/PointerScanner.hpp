@@ -0,0 +1,176 @@
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/PointerScanner.hpp"
+#include "med/MedException.hpp"
+
+class TestPointerScanner : public CxxTest::TestSuite {
+public:
+  // staticData[1] -> heapData, heapData[2] -> targetData, target is targetData[1]
+  Address staticData[4] = {0};
+  Address heapData[8] = {0};
+  int targetData[4] = {0};
+
+  vector<PointerRegion> createRegions(Address* staticData, Address* heapData, int* targetData) {
+    staticData[1] = (Address)heapData;
+    heapData[2] = (Address)targetData;
+    return {
+      { (Address)staticData, (Address)(staticData + 4), true, true, "/tmp/libtest.so" },
+      { (Address)heapData, (Address)(heapData + 8), true, false, "[heap]" },
+      { (Address)targetData, (Address)(targetData + 4), false, false, "" }
+    };
+  }
+
+  vector<PointerRegion> createRegions() {
+    return createRegions(staticData, heapData, targetData);
+  }
+
+  void testIndex() {
+    MemIO memio;
+    PointerScanner scanner(&memio);
+    scanner.buildIndex(createRegions());
+
+    auto index = scanner.getEntries();
+    TS_ASSERT_EQUALS(scanner.size(), 2);
+    TS_ASSERT(index[0].target < index[1].target);
+    for (size_t i = 0; i < scanner.size(); i++) {
+      if (index[i].source == (Address)&staticData[1]) {
+        TS_ASSERT_EQUALS(index[i].target, (Address)heapData);
+      }
+      else {
+        TS_ASSERT_EQUALS(index[i].source, (Address)&heapData[2]);
+      }
+    }
+  }
+
+  void testFindPaths() {
+    MemIO memio;
+    PointerScanner scanner(&memio);
+    scanner.buildIndex(createRegions());
+
+    PointerScanOptions options;
+    options.maxOffset = 0x20; // The arrays are adjacent
+    auto paths = scanner.findPaths((Address)&targetData[1], options);
+    TS_ASSERT_EQUALS(paths.size(), 1);
+    TS_ASSERT_EQUALS(paths[0].base, (Address)&staticData[1]);
+    TS_ASSERT_EQUALS(paths[0].moduleOffset, sizeof(Address));
+    TS_ASSERT_EQUALS(paths[0].offsets.size(), 2);
+    TS_ASSERT_EQUALS(paths[0].offsets[0], 2 * sizeof(Address));
+    TS_ASSERT_EQUALS(paths[0].offsets[1], sizeof(int));
+    TS_ASSERT_EQUALS(paths[0].toString(), "[[libtest.so+0x8]+0x10]+0x4");
+  }
+
+  void testLimits() {
+    MemIO memio;
+    PointerScanner scanner(&memio);
+    scanner.buildIndex(createRegions());
+
+    PointerScanOptions options;
+    options.maxOffset = 0x20;
+    options.depth = 1;
+    TS_ASSERT_EQUALS(scanner.findPaths((Address)&targetData[1], options).size(), 0);
+
+    options.depth = 2;
+    options.maxOffset = 8;
+    TS_ASSERT_EQUALS(scanner.findPaths((Address)&targetData[1], options).size(), 0);
+
+    options.maxOffset = 0x20;
+    options.maxResults = 0;
+    TS_ASSERT_EQUALS(scanner.findPaths((Address)&targetData[1], options).size(), 0);
+  }
+
+  void testSaveLoad() {
+    MemIO memio;
+    PointerScanner scanner(&memio);
+    scanner.buildIndex(createRegions());
+    scanner.save("/tmp/med-test.ptrmap");
+
+    PointerScanner loaded(&memio);
+    loaded.load("/tmp/med-test.ptrmap");
+    TS_ASSERT_EQUALS(loaded.size(), scanner.size());
+    TS_ASSERT_EQUALS(loaded.getRegions().size(), 3);
+    TS_ASSERT_EQUALS(loaded.getRegions()[0].name, "/tmp/libtest.so");
+
+    PointerScanOptions options;
+    options.maxOffset = 0x20;
+    auto paths = loaded.findPaths((Address)&targetData[1], options);
+    TS_ASSERT_EQUALS(paths.size(), 1);
+    TS_ASSERT_EQUALS(paths[0].toString(), "[[libtest.so+0x8]+0x10]+0x4");
+    remove("/tmp/med-test.ptrmap");
+  }
+
+  void testInvalidMap() {
+    MemIO memio;
+    PointerScanner scanner(&memio);
+    scanner.buildIndex(createRegions());
+    scanner.save("/tmp/med-test.ptrmap");
+
+    FILE* file = fopen("/tmp/med-test.ptrmap", "rb");
+    vector<char> saved(4096);
+    saved.resize(fread(saved.data(), 1, saved.size(), file));
+    fclose(file);
+
+    auto loadPatched = [&](void (*patch)(char*), size_t size) {
+      FILE* file = fopen("/tmp/med-test.ptrmap", "wb");
+      vector<char> bytes = saved;
+      patch(bytes.data());
+      fwrite(bytes.data(), 1, size, file);
+      fclose(file);
+      PointerScanner loaded(&memio);
+      TS_ASSERT_THROWS(loaded.load("/tmp/med-test.ptrmap"), MedException);
+    };
+
+    // Truncated, the entries are cut off
+    loadPatched([](char*) {}, saved.size() - sizeof(PointerEntry));
+    // The entry count wraps the size around
+    loadPatched([](char* bytes) {
+      ((PointerMapHeader*)bytes)->entryCount = (uint64_t)-1 / sizeof(PointerEntry) + 2;
+    }, saved.size());
+    // The region count wraps the size around
+    loadPatched([](char* bytes) {
+      ((PointerMapHeader*)bytes)->regionCount = (uint64_t)-1 / sizeof(PointerMapRegion) + 2;
+    }, saved.size());
+    // Name outside of the names
+    loadPatched([](char* bytes) {
+      auto header = (PointerMapHeader*)bytes;
+      ((PointerMapRegion*)(bytes + header->regionsOffset))->nameOffset = (uint64_t)-4;
+    }, saved.size());
+    loadPatched([](char* bytes) {
+      ((PointerMapHeader*)bytes)->regionsOffset += 4;
+    }, saved.size());
+    loadPatched([](char* bytes) {
+      ((PointerMapHeader*)bytes)->pointerSize = 2;
+    }, saved.size());
+    remove("/tmp/med-test.ptrmap");
+  }
+
+  void testIntersect() {
+    MemIO memio;
+    PointerScanner scanner(&memio);
+    staticData[3] = (Address)heapData; // Only in the first run
+    scanner.buildIndex(createRegions());
+    scanner.save("/tmp/med-test-1.ptrmap");
+
+    // Another run, at other addresses
+    vector<Address> otherStatic(4, 0);
+    vector<Address> otherHeap(8, 0);
+    vector<int> otherTarget(4, 0);
+    scanner.buildIndex(createRegions(otherStatic.data(), otherHeap.data(), otherTarget.data()));
+    scanner.save("/tmp/med-test-2.ptrmap");
+
+    PointerScanOptions options;
+    options.maxOffset = 0x20;
+    auto paths = PointerScanner::intersect({
+        { "/tmp/med-test-1.ptrmap", (Address)&targetData[1] },
+        { "/tmp/med-test-2.ptrmap", (Address)&otherTarget[1] }
+      }, options);
+    TS_ASSERT_EQUALS(paths.size(), 1);
+    TS_ASSERT_EQUALS(paths[0].toString(), "[[libtest.so+0x8]+0x10]+0x4");
+    TS_ASSERT_EQUALS(paths[0].base, (Address)&otherStatic[1]);
+
+    remove("/tmp/med-test-1.ptrmap");
+    remove("/tmp/med-test-2.ptrmap");
+  }
+};
@@ -0,0 +1,51 @@
+#include <memory>
+#include <cxxtest/TestSuite.h>
+
+#include "mem/Pem.hpp"
+#include "mem/ResultArena.hpp"
+
+using namespace std;
+
+class TestResultArena : public CxxTest::TestSuite {
+public:
+  void testAllocate() {
+    ResultArena arena;
+    TS_ASSERT_EQUALS(arena.getChunkCount(), 0);
+
+    Byte* first = (Byte*)arena.allocate(3, 1);
+    void* aligned = arena.allocate(8, 8);
+    TS_ASSERT_EQUALS((size_t)aligned % 8, 0);
+    TS_ASSERT((Byte*)aligned >= first + 3);
+    TS_ASSERT_EQUALS(arena.getChunkCount(), 1);
+    TS_ASSERT_EQUALS(arena.getBytesUsed(), 11);
+
+    arena.allocate(RESULT_ARENA_FIRST_CHUNK, 8); // Does not fit the first chunk
+    TS_ASSERT_EQUALS(arena.getChunkCount(), 2);
+    arena.allocate(4 * RESULT_ARENA_LAST_CHUNK, 8); // Larger than a chunk
+    TS_ASSERT_EQUALS(arena.getChunkCount(), 3);
+  }
+
+  void testCreatePem() {
+    int memory = 100;
+    ResultArenaPtr arena = make_shared<ResultArena>();
+    weak_ptr<ResultArena> weak = arena;
+
+    vector<MemPtr> list;
+    for (int i = 0; i < 1000; i++) {
+      PemPtr pem = Pem::create((Address)&memory, 4, NULL, arena);
+      pem->setScanType(SCAN_TYPE_INT_32);
+      pem->rememberValue((Byte*)&i, 4);
+      list.push_back(pem);
+    }
+    TS_ASSERT_EQUALS(static_pointer_cast<Pem>(list[999])->recallValue(SCAN_TYPE_INT_32), "999");
+    TS_ASSERT_EQUALS(list[0]->getAddress(), (Address)&memory);
+    TS_ASSERT(arena->getChunkCount() > 1);
+
+    arena.reset();
+    TS_ASSERT(!weak.expired()); // Kept by the hits
+    list.erase(list.begin(), list.begin() + 999);
+    TS_ASSERT(!weak.expired());
+    list.clear();
+    TS_ASSERT(weak.expired());
+  }
+};
@@ -0,0 +1,53 @@
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include <json/json.h>
+#include <cxxtest/TestSuite.h>
+
+#include "med/Tracer.hpp"
+
+using namespace std;
+
+class TestTracer : public CxxTest::TestSuite {
+public:
+  void testSave() {
+    Tracer& tracer = Tracer::get();
+    tracer.start();
+    {
+      TraceSpan span("outer", "test", "size", 4096);
+      std::thread([] {
+        Tracer::get().nameThread("other");
+        TraceSpan span("inner", "test");
+      }).join();
+    }
+    tracer.stop();
+    {
+      TraceSpan span("stopped", "test"); // Not recorded
+    }
+    TS_ASSERT_EQUALS(tracer.size(), 2);
+
+    string filename = "/tmp/med-trace-" + to_string(getpid()) + ".json";
+    tracer.save(filename);
+    Json::Value root;
+    ifstream(filename) >> root;
+    remove(filename.c_str());
+
+    auto& events = root["traceEvents"];
+    int spans = 0;
+    bool named = false;
+    for (auto& event : events) {
+      if (event["ph"].asString() == "M") {
+        named = named || event["args"]["name"].asString() == "other";
+        continue;
+      }
+      spans++;
+      TS_ASSERT(event["dur"].asDouble() >= 0);
+      if (event["name"].asString() == "outer") {
+        TS_ASSERT_EQUALS(event["args"]["size"].asInt(), 4096);
+      }
+    }
+    TS_ASSERT_EQUALS(spans, 2);
+    TS_ASSERT(named);
+  }
+};